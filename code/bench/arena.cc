@@ -0,0 +1,175 @@
+// Allocation benchmark: the std::shared_ptr nodes of match-tree-step6.cc
+// against the misc::arena nodes of match-tree-arena.cc.
+//
+// Both sides build the trees of step6's main function N times and keep them
+// alive, then free everything.
+//
+// Usage: ./bench/arena [N]
+
+#include <memory>
+#include <vector>
+
+#include "../cpp-matching-hacks/lib/arena.hh"
+#include "bench.hh"
+
+// Nodes from match-tree-step6.cc, stripped down to their layout
+namespace shared
+{
+    struct Tree
+    {
+        virtual void traverse()
+        {}
+    };
+
+    struct Int
+        : public Tree
+        , std::enable_shared_from_this<Int>
+    {
+        Int(int val)
+            : val(val)
+        {}
+
+        int val;
+    };
+
+    template <typename T>
+    struct Mem
+        : public Tree
+        , std::enable_shared_from_this<Mem<T>>
+    {
+        Mem(std::shared_ptr<T> exp)
+            : exp(exp)
+        {}
+
+        std::shared_ptr<T> exp;
+    };
+
+    template <typename D, typename S>
+    struct Move
+        : public Tree
+        , std::enable_shared_from_this<Move<D, S>>
+    {
+        Move(std::shared_ptr<D> dst, std::shared_ptr<S> src)
+            : dst(dst)
+            , src(src)
+        {}
+
+        std::shared_ptr<D> dst;
+        std::shared_ptr<S> src;
+    };
+
+    template <typename T>
+    static std::shared_ptr<Mem<T>> make_mem(const std::shared_ptr<T>& exp)
+    {
+        return std::shared_ptr<Mem<T>>(new Mem(exp));
+    }
+
+    template <typename D, typename S>
+    static std::shared_ptr<Move<D, S>> make_move(const std::shared_ptr<D>& dst,
+                                                 const std::shared_ptr<S>& src)
+    {
+        return std::shared_ptr<Move<D, S>>(new Move(dst, src));
+    }
+} // namespace shared
+
+// Nodes from match-tree-arena.cc, stripped down to their layout
+namespace pooled
+{
+    struct Tree
+    {
+        virtual void traverse()
+        {}
+    };
+
+    struct Int : public Tree
+    {
+        Int(int val)
+            : val(val)
+        {}
+
+        int val;
+    };
+
+    template <typename T>
+    struct Mem : public Tree
+    {
+        Mem(T* exp)
+            : exp(exp)
+        {}
+
+        T* exp;
+    };
+
+    template <typename D, typename S>
+    struct Move : public Tree
+    {
+        Move(D* dst, S* src)
+            : dst(dst)
+            , src(src)
+        {}
+
+        D* dst;
+        S* src;
+    };
+} // namespace pooled
+
+static void run_shared(long n)
+{
+    using namespace shared;
+
+    std::vector<std::shared_ptr<Move<Int, Mem<Mem<Int>>>>> moves1;
+    std::vector<std::shared_ptr<Move<Int, Int>>> moves2;
+    moves1.reserve(n);
+    moves2.reserve(n);
+
+    for (long i = 0; i < n; ++i)
+    {
+        std::shared_ptr<Int> i1(new Int(42));
+        std::shared_ptr<Int> i2(new Int(21));
+
+        auto mem1 = make_mem(i1);
+        auto mem2 = make_mem(mem1);
+        moves1.push_back(make_move(i2, mem2));
+        moves2.push_back(make_move(i2, i1));
+    }
+
+    bench::do_not_optimize(moves1.data());
+    bench::do_not_optimize(moves2.data());
+}
+
+static void run_arena(long n)
+{
+    using namespace pooled;
+
+    misc::arena arena;
+
+    std::vector<Move<Int, Mem<Mem<Int>>>*> moves1;
+    std::vector<Move<Int, Int>*> moves2;
+    moves1.reserve(n);
+    moves2.reserve(n);
+
+    for (long i = 0; i < n; ++i)
+    {
+        auto i1 = arena.make<Int>(42);
+        auto i2 = arena.make<Int>(21);
+
+        auto mem1 = arena.make<Mem<Int>>(i1);
+        auto mem2 = arena.make<Mem<Mem<Int>>>(mem1);
+        moves1.push_back(arena.make<Move<Int, Mem<Mem<Int>>>>(i2, mem2));
+        moves2.push_back(arena.make<Move<Int, Int>>(i2, i1));
+    }
+
+    bench::do_not_optimize(moves1.data());
+    bench::do_not_optimize(moves2.data());
+}
+
+int main(int argc, char* argv[])
+{
+    long n = bench::arg(argc, argv, 1, 1000000);
+
+    std::printf("%ld trees, %ld nodes\n", 2 * n, 6 * n);
+    bench::isolated("shared_ptr", [n] { run_shared(n); });
+    bench::isolated("arena", [n] { run_arena(n); });
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+// Matching benchmark: the compile-time tree automaton of
+// match-tree-automaton.cc against nested std::visit calls, as in the slides'
+// GasMatcher, on a synthetic corpus.  Every node of the corpus is matched.
+//
+// Usage: ./bench/automaton [NODES]
+
+#include <cstdio>
+#include <type_traits>
+
+#include "../cpp-matching-hacks/lib/tree-automaton.hh"
+#include "bench.hh"
+#include "generator.hh"
+
+using namespace plain;
+
+enum Rule
+{
+    MEM_MEM,
+    MEM,
+    MOVE_INT_INT,
+    MOVE_MEM_MEM,
+    MOVE,
+    WILD,
+    RULE_COUNT,
+};
+
+using misc::op;
+using misc::wild;
+
+using Automaton = misc::tree_automaton<
+    Tree::kind_count,
+    op<Tree::MEM, op<Tree::MEM, wild>>,
+    op<Tree::MEM, wild>,
+    op<Tree::MOVE, op<Tree::INT>, op<Tree::INT>>,
+    op<Tree::MOVE, op<Tree::MEM, wild>, op<Tree::MEM, wild>>,
+    op<Tree::MOVE, wild, wild>,
+    wild>;
+
+/// The same rules, destructuring children with nested visits.
+struct VisitMatcher
+{
+    int operator()(Int*)
+    {
+        return WILD;
+    }
+
+    int operator()(Mem* m)
+    {
+        return std::visit(
+            [](auto* exp) {
+                return std::is_same_v<decltype(exp), Mem*> ? MEM_MEM : MEM;
+            },
+            m->exp->variant());
+    }
+
+    int operator()(Move* m)
+    {
+        return std::visit(
+            [](auto* dst, auto* src) {
+                using D = decltype(dst);
+                using S = decltype(src);
+                if constexpr (std::is_same_v<D, Int*>
+                              && std::is_same_v<S, Int*>)
+                    return MOVE_INT_INT;
+                else if constexpr (std::is_same_v<D, Mem*>
+                                   && std::is_same_v<S, Mem*>)
+                    return MOVE_MEM_MEM;
+                else
+                    return MOVE;
+            },
+            m->dst->variant(), m->src->variant());
+    }
+};
+
+static void visit_all(Tree* t, long* hits)
+{
+    for (std::size_t i = 0; i < t->child_count(); ++i)
+        visit_all(t->child_get(i), hits);
+    ++hits[std::visit(VisitMatcher(), t->variant())];
+}
+
+int main(int argc, char* argv[])
+{
+    bench::corpus_params params;
+    params.nodes = bench::arg(argc, argv, 1, 1000000);
+    bench::corpus corpus(params);
+
+    long visit_hits[RULE_COUNT] = {};
+    double visit_ms = bench::time_ms([&] {
+        for (auto root : corpus.roots_get())
+            visit_all(root, visit_hits);
+    });
+
+    long automaton_hits[RULE_COUNT] = {};
+    double automaton_ms = bench::time_ms([&] {
+        for (auto root : corpus.roots_get())
+            Automaton::match_all(*root, [&](const Tree&, int rule) {
+                ++automaton_hits[rule];
+            });
+    });
+
+    for (int r = 0; r < RULE_COUNT; ++r)
+        if (visit_hits[r] != automaton_hits[r])
+        {
+            std::printf("rule %d: %ld hits with std::visit, %ld with the "
+                        "automaton\n",
+                        r, visit_hits[r], automaton_hits[r]);
+            return 1;
+        }
+
+    std::printf("%zu nodes, %zu automaton states\n", corpus.size(),
+                Automaton::state_count());
+    std::printf("%-24s %10.2f ms %8.2f ns/node\n", "nested std::visit",
+                visit_ms, visit_ms * 1e6 / corpus.size());
+    std::printf("%-24s %10.2f ms %8.2f ns/node\n", "tree_automaton",
+                automaton_ms, automaton_ms * 1e6 / corpus.size());
+
+    return 0;
+}
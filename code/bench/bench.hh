@@ -0,0 +1,87 @@
+/**
+ ** \file bench/bench.hh
+ ** \brief Small helpers shared by the benchmarks.
+ **/
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace bench
+{
+    using clock = std::chrono::steady_clock;
+
+    /// Prevent the compiler from optimizing away \a value.
+    template <typename T>
+    inline void do_not_optimize(const T& value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /// Return the time spent running \a f, in milliseconds.
+    template <typename F>
+    double time_ms(F&& f)
+    {
+        auto start = clock::now();
+        f();
+        std::chrono::duration<double, std::milli> elapsed =
+            clock::now() - start;
+        return elapsed.count();
+    }
+
+    /// Return the peak resident set size of the current process, in kB.
+    inline long peak_rss_kb()
+    {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    }
+
+    /// Read the \a i th command line argument as a number, or \a dflt.
+    inline long arg(int argc, char* argv[], int i, long dflt)
+    {
+        return argc > i ? std::strtol(argv[i], nullptr, 10) : dflt;
+    }
+
+    /// Run \a f in a forked process and report its running time and peak
+    /// RSS, so that allocations of one run do not pollute the next one.
+    template <typename F>
+    void isolated(const std::string& name, F&& f)
+    {
+        int fds[2];
+        if (pipe(fds))
+            std::abort();
+
+        std::fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(fds[0]);
+            double ms = time_ms(f);
+            if (write(fds[1], &ms, sizeof ms) != sizeof ms)
+                _exit(1);
+            _exit(0);
+        }
+
+        close(fds[1]);
+        double ms = 0;
+        if (read(fds[0], &ms, sizeof ms) != sizeof ms)
+            ms = -1;
+        close(fds[0]);
+
+        int status;
+        rusage usage;
+        wait4(pid, &status, 0, &usage);
+
+        std::printf("%-24s %10.2f ms %10ld kB peak RSS\n", name.c_str(), ms,
+                    usage.ru_maxrss);
+    }
+
+} // namespace bench
@@ -0,0 +1,163 @@
+// Borrowed variant benchmark: step6's nodes matched through variant(), which
+// copies a std::shared_ptr from shared_from_this(), and through variant_ref(),
+// which borrows a raw pointer.
+//
+// THREADS threads match the same NODES nodes ROUNDS times, so that the
+// atomic reference counts variant() increments and decrements are contended.
+//
+// Usage: ./bench/borrowed [THREADS] [NODES] [ROUNDS]
+
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "bench.hh"
+#include "tree-step6.hh"
+
+using namespace step6;
+
+/// step6's rules on raw pointers, smart pointers being forwarded to them.
+struct Matcher
+{
+    enum Rule
+    {
+        AUTO,
+        MEM_MEM,
+        MEM,
+        MOVE_SAME,
+        MOVE_DIFF,
+        RULE_COUNT,
+    };
+
+    long hits[RULE_COUNT] = {};
+
+    template <typename T>
+    void operator()(const std::shared_ptr<T>& t)
+    {
+        (*this)(t.get());
+    }
+
+    void operator()(auto*)
+    {
+        ++hits[AUTO];
+    }
+
+    template <typename T>
+    void operator()(Mem<Mem<T>>*)
+    {
+        ++hits[MEM_MEM];
+    }
+
+    template <typename T>
+    void operator()(Mem<T>*)
+    {
+        ++hits[MEM];
+    }
+
+    template <typename T>
+    void operator()(Move<T, T>*)
+    {
+        ++hits[MOVE_SAME];
+    }
+
+    template <typename T1, typename T2>
+    void operator()(Move<T1, T2>*)
+    {
+        ++hits[MOVE_DIFF];
+    }
+
+    long checksum() const
+    {
+        long res = 0;
+        for (int r = 0; r < RULE_COUNT; ++r)
+            res += (r + 1) * hits[r];
+        return res;
+    }
+};
+
+struct Nodes
+{
+    std::vector<sInt> ints;
+    std::vector<sMem<Int>> mems;
+    std::vector<sMem<Mem<Int>>> mem_mems;
+    std::vector<sMove<Int, Int>> moves;
+    std::vector<sMove<Int, Mem<Int>>> stores;
+
+    /// Match every node, through variant_ref() if \a Borrowed.
+    template <bool Borrowed>
+    void match(Matcher& m) const
+    {
+        auto each = [&m](const auto& nodes) {
+            for (const auto& t : nodes)
+                if constexpr (Borrowed)
+                    std::visit(m, t->variant_ref());
+                else
+                    std::visit(m, t->variant());
+        };
+        each(ints);
+        each(mems);
+        each(mem_mems);
+        each(moves);
+        each(stores);
+    }
+
+    std::size_t size() const
+    {
+        return ints.size() + mems.size() + mem_mems.size() + moves.size()
+            + stores.size();
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    long threads = bench::arg(argc, argv, 1, 4);
+    long n = bench::arg(argc, argv, 2, 1000);
+    long rounds = bench::arg(argc, argv, 3, 2000);
+
+    Nodes nodes;
+    for (long i = 0; i < n / 5; ++i)
+    {
+        sInt imm(new Int(i));
+        auto mem = make_mem(imm);
+        nodes.ints.push_back(imm);
+        nodes.mems.push_back(mem);
+        nodes.mem_mems.push_back(make_mem(mem));
+        nodes.moves.push_back(make_move(imm, sInt(new Int(i))));
+        nodes.stores.push_back(make_move(imm, mem));
+    }
+
+    auto run = [&](const char* name, auto borrowed) {
+        std::vector<long> sums(threads);
+        double ms = bench::time_ms([&] {
+            std::vector<std::jthread> workers;
+            for (long t = 0; t < threads; ++t)
+                workers.emplace_back([&, t] {
+                    Matcher m;
+                    for (long r = 0; r < rounds; ++r)
+                        nodes.match<decltype(borrowed)::value>(m);
+                    sums[t] = m.checksum();
+                });
+        });
+        long matches = threads * rounds * nodes.size();
+        std::printf("%-16s %10.2f ms %8.2f ns/match\n", name, ms,
+                    ms * 1e6 / matches);
+        long res = 0;
+        for (long s : sums)
+            res += s;
+        return res;
+    };
+
+    std::printf("%ld threads, %zu shared nodes\n", threads, nodes.size());
+    long owning = run("variant()", std::false_type());
+    long borrowed = run("variant_ref()", std::true_type());
+    if (owning != borrowed)
+    {
+        std::printf("variant() and variant_ref() disagree\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,200 @@
+// Batched classification benchmark: the rule of every node of the corpus,
+// the rules being those of match-tree-flat.cc, none deeper than its shape.
+//
+// - std::visit: per node, on the pointer tree, with nested std::visit on the
+//   children.
+// - classify: misc::kind_classifier on the same forest stored in a
+//   misc::flat_tree, children kinds gathered by batch, then the first
+//   candidate of each mask.  Once per kernel the CPU supports.
+// - kernel: the compare kernel alone, on kinds gathered beforehand.
+//
+// Usage: ./bench/classify [NODES] [ROUNDS]
+
+#include <bit>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "../cpp-matching-hacks/lib/flat-tree.hh"
+#include "../cpp-matching-hacks/lib/kind-classifier.hh"
+#include "bench.hh"
+#include "generator.hh"
+
+using namespace plain;
+using misc::flat_tree;
+using misc::kind_classifier;
+
+/// The rules, in order.
+enum Rule
+{
+    MEM_MEM,
+    MEM,
+    MOVE_INT,
+    MOVE_MEM,
+    MOVE,
+    WILD,
+};
+
+static const std::vector<misc::shape> shapes = {
+    {Tree::MEM, Tree::MEM},
+    {Tree::MEM},
+    {Tree::MOVE, Tree::INT, Tree::INT},
+    {Tree::MOVE, Tree::MEM, Tree::MEM},
+    {Tree::MOVE},
+    {},
+};
+
+struct MoveMatcher
+{
+    int operator()(Int*, Int*) const
+    {
+        return MOVE_INT;
+    }
+
+    int operator()(Mem*, Mem*) const
+    {
+        return MOVE_MEM;
+    }
+
+    template <typename D, typename S>
+    int operator()(D*, S*) const
+    {
+        return MOVE;
+    }
+};
+
+struct Matcher
+{
+    int operator()(Int*) const
+    {
+        return WILD;
+    }
+
+    int operator()(Mem* m) const
+    {
+        return std::visit(
+            [](auto* exp) {
+                return std::is_same_v<decltype(exp), Mem*> ? MEM_MEM : MEM;
+            },
+            m->exp->variant());
+    }
+
+    int operator()(Move* m) const
+    {
+        return std::visit(MoveMatcher(), m->dst->variant(),
+                          m->src->variant());
+    }
+};
+
+/// Every node under \a t, in the post-order of flatten().
+static void collect(Tree* t, std::vector<Tree*>& nodes)
+{
+    for (std::size_t i = 0; i < t->child_count(); ++i)
+        collect(t->child_get(i), nodes);
+    nodes.push_back(t);
+}
+
+static flat_tree::index_type flatten(flat_tree& res, const Tree* t)
+{
+    switch (t->kind_get())
+    {
+    case Tree::INT:
+        return res.add_leaf(Tree::INT, static_cast<const Int*>(t)->val);
+    case Tree::MEM:
+        return res.add_node(Tree::MEM, {flatten(res, t->child_get(0))});
+    default:
+        {
+            auto dst = flatten(res, t->child_get(0));
+            auto src = flatten(res, t->child_get(1));
+            return res.add_node(Tree::MOVE, {dst, src});
+        }
+    }
+}
+
+static void report(const char* name, double ms, long n)
+{
+    std::printf("%-20s %10.2f ms %8.2f ns/node\n", name, ms, ms * 1e6 / n);
+}
+
+int main(int argc, char* argv[])
+{
+    bench::corpus_params params;
+    params.nodes = bench::arg(argc, argv, 1, 1000000);
+    long rounds = bench::arg(argc, argv, 2, 10);
+    bench::corpus corpus(params);
+
+    std::vector<Tree*> nodes;
+    flat_tree flat;
+    for (auto root : corpus.roots_get())
+    {
+        collect(root, nodes);
+        flatten(flat, root);
+    }
+    long n = nodes.size() * rounds;
+    std::printf("%zu nodes, best kernel: %s\n", nodes.size(),
+                misc::simd_name(misc::simd_support()));
+
+    long visit_sum = 0;
+    double visit_ms = bench::time_ms([&] {
+        for (long r = 0; r < rounds; ++r)
+            for (auto t : nodes)
+                visit_sum += std::visit(Matcher(), t->variant());
+    });
+    report("std::visit", visit_ms, n);
+
+    // The kinds the classifier gathers, once and for all
+    std::vector<flat_tree::kind_type> kinds(flat.size());
+    std::vector<flat_tree::kind_type> firsts(flat.size());
+    std::vector<flat_tree::kind_type> seconds(flat.size());
+    for (flat_tree::index_type i = 0; i < flat.size(); ++i)
+    {
+        std::size_t arity = flat.child_count(i);
+        kinds[i] = flat.kind_get(i);
+        firsts[i] = arity > 0 ? flat.kind_get(flat.child_get(i, 0))
+                              : kind_classifier::none;
+        seconds[i] = arity > 1 ? flat.kind_get(flat.child_get(i, 1))
+                               : kind_classifier::none;
+    }
+
+    for (auto level : {misc::simd_level::scalar, misc::simd_level::sse2,
+                       misc::simd_level::avx2})
+    {
+        kind_classifier classifier(shapes, level);
+        if (classifier.level_get() != level)
+            continue;
+        const char* name = misc::simd_name(level);
+        std::vector<kind_classifier::mask_type> masks;
+
+        long sum = 0;
+        double ms = bench::time_ms([&] {
+            for (long r = 0; r < rounds; ++r)
+            {
+                classifier.classify(flat, masks);
+                for (auto m : masks)
+                    sum += std::countr_zero(m);
+            }
+        });
+        report((name + std::string(" classify")).c_str(), ms, n);
+
+        ms = bench::time_ms([&] {
+            for (long r = 0; r < rounds; ++r)
+            {
+                classifier.classify(kinds.data(), firsts.data(),
+                                    seconds.data(), flat.size(),
+                                    masks.data());
+                bench::do_not_optimize(masks.data());
+            }
+        });
+        report((name + std::string(" kernel")).c_str(), ms, n);
+
+        if (sum != visit_sum)
+        {
+            std::printf("std::visit and %s disagree\n", name);
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+// Type test benchmark: misc::ref's is_a and unsafe_cast through dynamic_cast
+// against classof kind ranges, on a deep and a wide hierarchy.
+//
+// The deep hierarchy is a chain of DEPTH classes, the wide one has WIDTH
+// leaves.  Both come in two flavors, with and without classof, and the same
+// random objects are tested in both.
+//
+// Usage: ./bench/classof [N] [ROUNDS]
+
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "../cpp-matching-hacks/lib/ref-fixed.hh"
+#include "bench.hh"
+
+constexpr int DEPTH = 16;
+constexpr int WIDTH = 32;
+
+template <bool Tagged>
+struct Base
+{
+    Base(int kind)
+        : kind(kind)
+    {}
+
+    virtual ~Base() = default;
+
+    int kind;
+};
+
+/// Deep<Tagged, L> is the L-th class of the chain, its kind is L and the kinds
+/// of its subclasses are [L, DEPTH - 1].
+template <bool Tagged, int Level>
+struct Deep : public Deep<Tagged, Level - 1>
+{
+    Deep(int kind = Level)
+        : Deep<Tagged, Level - 1>(kind)
+    {}
+
+    static bool classof(const Base<Tagged>* b) requires Tagged
+    {
+        return misc::in_kind_range<Level, DEPTH - 1>(b->kind);
+    }
+};
+
+template <bool Tagged>
+struct Deep<Tagged, 0> : public Base<Tagged>
+{
+    Deep(int kind = 0)
+        : Base<Tagged>(kind)
+    {}
+};
+
+/// Wide<Tagged, I> is the I-th leaf, its kind is I.
+template <bool Tagged, int I>
+struct Wide : public Base<Tagged>
+{
+    Wide()
+        : Base<Tagged>(I)
+    {}
+
+    static bool classof(const Base<Tagged>* b) requires Tagged
+    {
+        return misc::in_kind_range<I>(b->kind);
+    }
+};
+
+template <bool Tagged>
+using sBase = misc::ref<Base<Tagged>>;
+
+template <bool Tagged, template <bool, int> class Node, int... Is>
+static std::vector<sBase<Tagged>>
+make_objects(long n, std::integer_sequence<int, Is...>)
+{
+    using factory = Base<Tagged>* (*)();
+    static constexpr factory factories[] = {
+        []() -> Base<Tagged>* { return new Node<Tagged, Is>(); }...};
+
+    std::mt19937 rng(42);
+    std::vector<sBase<Tagged>> res;
+    res.reserve(n);
+    for (long i = 0; i < n; ++i)
+        res.emplace_back(factories[rng() % sizeof...(Is)]());
+    return res;
+}
+
+/// Time \a test on every object, \a rounds times, in ns per object.
+template <typename Objects, typename Test>
+static double time_ns(const Objects& objects, long rounds, long& hits,
+                      Test test)
+{
+    hits = 0;
+    double ms = bench::time_ms([&] {
+        for (long r = 0; r < rounds; ++r)
+            for (const auto& o : objects)
+                hits += test(o);
+    });
+    bench::do_not_optimize(hits);
+    return ms * 1e6 / (rounds * objects.size());
+}
+
+/// Compare dynamic_cast with classof on is_a<U> and unsafe_cast<U>, where
+/// \a U is Node<Tagged, I>.
+template <template <bool, int> class Node, int I>
+static bool compare(const char* name, const std::vector<sBase<false>>& plain,
+                    const std::vector<sBase<true>>& tagged, long rounds)
+{
+    using U = Node<false, I>;
+    using V = Node<true, I>;
+    static_assert(!misc::classof_from<U, Base<false>>);
+    static_assert(misc::classof_from<V, Base<true>>);
+
+    long hits[4];
+    double ns[4] = {
+        time_ns(plain, rounds, hits[0],
+                [](const auto& o) { return o.template is_a<U>(); }),
+        time_ns(tagged, rounds, hits[1],
+                [](const auto& o) { return o.template is_a<V>(); }),
+        time_ns(plain, rounds, hits[2],
+                [](const auto& o) {
+                    return bool(o.template unsafe_cast<U>());
+                }),
+        time_ns(tagged, rounds, hits[3],
+                [](const auto& o) {
+                    return bool(o.template unsafe_cast<V>());
+                }),
+    };
+
+    std::printf("%-10s is_a %6.2f / %6.2f ns   unsafe_cast %6.2f / %6.2f ns\n",
+                name, ns[0], ns[1], ns[2], ns[3]);
+    return hits[0] == hits[1] && hits[1] == hits[2] && hits[2] == hits[3];
+}
+
+int main(int argc, char* argv[])
+{
+    long n = bench::arg(argc, argv, 1, 1000000);
+    long rounds = bench::arg(argc, argv, 2, 10);
+
+    auto deep_plain =
+        make_objects<false, Deep>(n, std::make_integer_sequence<int, DEPTH>());
+    auto deep_tagged =
+        make_objects<true, Deep>(n, std::make_integer_sequence<int, DEPTH>());
+    auto wide_plain =
+        make_objects<false, Wide>(n, std::make_integer_sequence<int, WIDTH>());
+    auto wide_tagged =
+        make_objects<true, Wide>(n, std::make_integer_sequence<int, WIDTH>());
+
+    std::printf("%ld objects, %ld rounds, dynamic_cast / classof\n", n,
+                rounds);
+    bool ok = compare<Deep, 1>("Deep<1>", deep_plain, deep_tagged, rounds)
+        && compare<Deep, DEPTH - 1>("Deep<15>", deep_plain, deep_tagged,
+                                    rounds)
+        && compare<Wide, 0>("Wide<0>", wide_plain, wide_tagged, rounds)
+        && compare<Wide, WIDTH - 1>("Wide<31>", wide_plain, wide_tagged,
+                                    rounds);
+    if (!ok)
+    {
+        std::printf("dynamic_cast and classof disagree\n");
+        return 1;
+    }
+
+    return 0;
+}
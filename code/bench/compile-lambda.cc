@@ -0,0 +1,57 @@
+// Code size benchmark: a matcher with one specific overload and a catch-all,
+// over variants of 2 to 64 alternatives, see bench/input/lambda-visitor.cc.
+//
+// - auto: the catch-all takes auto, visited with std::visit.
+// - base: the catch-all takes the base of the nodes, visited with std::visit.
+// - LambdaVisitor: the same, in a misc::LambdaVisitor visited with
+//   misc::visit, which routes the alternatives reaching only the catch-all
+//   through one function.
+//
+// Must be run from the code/ directory, the compiler is taken from $CXX.
+//
+// Usage: ./bench/compile-lambda [MAX_ALTS]
+
+#include <cstdio>
+#include <string>
+
+#include "compile.hh"
+
+int main(int argc, char* argv[])
+{
+    long max_alts = bench::arg(argc, argv, 1, 64);
+    std::string object = "/tmp/bench-compile-lambda.o";
+    const char* names[] = {"auto", "base", "LambdaVisitor"};
+
+    std::printf("compiled with %s -O2\n", bench::cxx().c_str());
+    std::printf("%-6s %-14s %10s %12s %10s\n", "alts", "matcher", "seconds",
+                ".text B", "weak fns");
+
+    for (long alts = 2; alts <= max_alts; alts *= 2)
+        for (int mode = 0; mode < 3; ++mode)
+        {
+            std::vector<std::string> cmd = {
+                bench::cxx(),
+                "-std=c++20",
+                "-O2",
+                "-c",
+                "bench/input/lambda-visitor.cc",
+                "-o",
+                object,
+                "-DALTS=" + std::to_string(alts),
+                "-DMODE=" + std::to_string(mode),
+            };
+
+            auto stats = bench::run_compiler(cmd);
+            if (!stats.ok)
+            {
+                std::printf("%-6ld %-14s %10s\n", alts, names[mode], "failed");
+                continue;
+            }
+            std::printf("%-6ld %-14s %10.2f %12ld %10ld\n", alts, names[mode],
+                        stats.seconds, bench::text_size(object),
+                        bench::symbol_count(object, true));
+        }
+
+    std::remove(object.c_str());
+    return 0;
+}
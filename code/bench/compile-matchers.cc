@@ -0,0 +1,126 @@
+// Compile-time benchmark: every matcher variant of the examples, compiled by
+// every given compiler at -O0 and -O2.
+//
+// Variants are cpp-matching/match-tree.cc, cpp-matching-hacks/match-tree-*.cc
+// and the minmax examples, plus match-tree-upcast-ref.cc with -DFIXED.
+// Compile wall time, peak compiler RSS, .text size and the number of
+// functions (all and weak ones, i.e. mostly template instantiations) are
+// printed, and written as JSON to REPORT.  Variants that do not compile, and
+// compilers that are not installed, are reported as failures.
+//
+// Must be run from the code/ directory.
+//
+// Usage: ./bench/compile-matchers [REPORT] [COMPILERS...]
+//        (bench/compile-matchers.json, g++ and clang++ by default)
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "compile.hh"
+
+struct variant
+{
+    std::string file;
+    std::string define;
+};
+
+static std::vector<variant> variants()
+{
+    std::vector<variant> res = {{"cpp-matching/match-tree.cc", ""}};
+    std::vector<std::string> hacks;
+    for (const auto& entry :
+         std::filesystem::directory_iterator("cpp-matching-hacks"))
+    {
+        std::string name = entry.path().filename();
+        if (entry.path().extension() == ".cc"
+            && (name.starts_with("match-tree") || name.starts_with("minmax")))
+            hacks.push_back(entry.path());
+    }
+    std::sort(hacks.begin(), hacks.end());
+    for (const auto& file : hacks)
+    {
+        res.push_back({file, ""});
+        if (file.ends_with("match-tree-upcast-ref.cc"))
+            res.push_back({file, "FIXED"});
+    }
+    return res;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string report = argc > 1 ? argv[1] : "bench/compile-matchers.json";
+    std::vector<std::string> compilers(argv + std::min(argc, 2), argv + argc);
+    if (compilers.empty())
+        compilers = {"g++", "clang++"};
+    std::string object = "/tmp/bench-compile-matchers.o";
+
+    FILE* json = std::fopen(report.c_str(), "w");
+    if (!json)
+    {
+        std::perror(report.c_str());
+        return 1;
+    }
+    std::fprintf(json, "[\n");
+
+    std::printf("%-52s %-8s %-3s %8s %10s %10s %6s %6s\n", "variant",
+                "compiler", "opt", "seconds", "peak kB", ".text B", "funcs",
+                "weak");
+
+    bool first = true;
+    for (const auto& compiler : compilers)
+    {
+        bool available = bench::run_compiler({compiler, "--version"}).ok;
+        for (const auto& v : variants())
+            for (std::string opt : {"-O0", "-O2"})
+            {
+                std::vector<std::string> cmd = {
+                    compiler, "-std=c++20", opt,    "-c",
+                    v.file,   "-o",         object,
+                };
+                if (!v.define.empty())
+                    cmd.push_back("-D" + v.define);
+
+                bench::compile_stats stats;
+                if (available)
+                    stats = bench::run_compiler(cmd);
+                long text = stats.ok ? bench::text_size(object) : -1;
+                long funcs = stats.ok ? bench::symbol_count(object) : -1;
+                long weak = stats.ok ? bench::symbol_count(object, true) : -1;
+
+                std::string name = v.file;
+                if (!v.define.empty())
+                    name += " -D" + v.define;
+                if (stats.ok)
+                    std::printf("%-52s %-8s %-3s %8.2f %10ld %10ld %6ld %6ld\n",
+                                name.c_str(), compiler.c_str(), opt.c_str(),
+                                stats.seconds, stats.peak_rss_kb, text, funcs,
+                                weak);
+                else
+                    std::printf("%-52s %-8s %-3s %8s\n", name.c_str(),
+                                compiler.c_str(), opt.c_str(),
+                                available ? "failed" : "missing");
+
+                std::fprintf(json,
+                             "%s  {\"file\": \"%s\", \"define\": \"%s\", "
+                             "\"compiler\": \"%s\", \"opt\": \"%s\", "
+                             "\"available\": %s, \"ok\": %s, "
+                             "\"seconds\": %.3f, \"peak_rss_kb\": %ld, "
+                             "\"text_bytes\": %ld, \"functions\": %ld, "
+                             "\"weak_functions\": %ld}",
+                             first ? "" : ",\n", v.file.c_str(),
+                             v.define.c_str(), compiler.c_str(), opt.c_str(),
+                             available ? "true" : "false",
+                             stats.ok ? "true" : "false", stats.seconds,
+                             stats.peak_rss_kb, text, funcs, weak);
+                first = false;
+            }
+    }
+
+    std::fprintf(json, "\n]\n");
+    std::fclose(json);
+    std::remove(object.c_str());
+    return 0;
+}
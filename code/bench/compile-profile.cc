@@ -0,0 +1,81 @@
+// Code size benchmark: the cost of misc::profiled, by compiling
+// match-tree-step6.cc, and match-tree-profile.cc which only wraps its
+// Matcher in misc::profiled, with and without -DMISC_PROFILE.
+//
+// Without the flag, the wrapper must cost nothing: the disassembly of
+// match-tree-profile.cc is compared to the one of match-tree-step6.cc.
+//
+// Must be run from the code/ directory, the compiler is taken from $CXX.
+//
+// Usage: ./bench/compile-profile
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "compile.hh"
+
+/// The disassembly of \a object, without its header naming the file.
+static std::string disassembly(const std::string& object)
+{
+    std::string cmd =
+        "objdump -d --no-show-raw-insn " + object + " 2>/dev/null | tail -n +4";
+    FILE* out = popen(cmd.c_str(), "r");
+    if (!out)
+        return "";
+    std::string res;
+    char chunk[4096];
+    while (std::size_t n = std::fread(chunk, 1, sizeof chunk, out))
+        res.append(chunk, n);
+    pclose(out);
+    return res;
+}
+
+int main()
+{
+    struct build
+    {
+        const char* name;
+        const char* file;
+        const char* define;
+    };
+    const build builds[] = {
+        {"step6", "cpp-matching-hacks/match-tree-step6.cc", nullptr},
+        {"profiled off", "cpp-matching-hacks/match-tree-profile.cc", nullptr},
+        {"profiled on", "cpp-matching-hacks/match-tree-profile.cc",
+         "-DMISC_PROFILE"},
+    };
+    std::string object = "/tmp/bench-compile-profile.o";
+
+    std::printf("compiled with %s\n", bench::cxx().c_str());
+    std::printf("%-4s %-14s %12s %10s  %s\n", "opt", "build", ".text B",
+                "functions", "code");
+
+    for (const char* opt : {"-O0", "-O2"})
+    {
+        std::string reference;
+        for (const auto& b : builds)
+        {
+            std::vector<std::string> cmd = {
+                bench::cxx(), "-std=c++20", opt, "-c", b.file, "-o", object,
+            };
+            if (b.define)
+                cmd.push_back(b.define);
+
+            if (!bench::run_compiler(cmd).ok)
+            {
+                std::printf("%-4s %-14s %12s\n", opt + 1, b.name, "failed");
+                continue;
+            }
+            std::string code = disassembly(object);
+            if (reference.empty())
+                reference = code;
+            std::printf("%-4s %-14s %12ld %10ld  %s\n", opt + 1, b.name,
+                        bench::text_size(object), bench::symbol_count(object),
+                        code == reference ? "same as step6" : "differs");
+        }
+    }
+
+    std::remove(object.c_str());
+    return 0;
+}
@@ -0,0 +1,55 @@
+// Compile-time benchmark: cost of visiting 1 to 8 variants with std::visit
+// against misc::visit_arms, see bench/input/visit.cc.
+//
+// Must be run from the code/ directory, the compiler is taken from $CXX.
+//
+// Usage: ./bench/compile-visit [ALTS] [MAX_ARGS]
+
+#include <cstdio>
+#include <string>
+
+#include "compile.hh"
+
+int main(int argc, char* argv[])
+{
+    long alts = bench::arg(argc, argv, 1, 2);
+    long max_args = bench::arg(argc, argv, 2, 8);
+    std::string object = "/tmp/bench-compile-visit.o";
+
+    std::printf("%ld alternatives per variant, compiled with %s\n", alts,
+                bench::cxx().c_str());
+    std::printf("%-6s %-12s %10s %12s %12s\n", "args", "visit", "seconds",
+                "peak kB", ".text B");
+
+    for (long n = 1; n <= max_args; ++n)
+        for (bool arms : {false, true})
+        {
+            std::vector<std::string> cmd = {
+                bench::cxx(),
+                "-std=c++20",
+                "-O2",
+                "-c",
+                "bench/input/visit.cc",
+                "-o",
+                object,
+                "-DALTS=" + std::to_string(alts),
+                "-DARGS=" + std::to_string(n),
+            };
+            if (arms)
+                cmd.push_back("-DUSE_ARMS");
+
+            auto stats = bench::run_compiler(cmd);
+            const char* name = arms ? "visit_arms" : "std::visit";
+            if (!stats.ok)
+            {
+                std::printf("%-6ld %-12s %10s\n", n, name, "failed");
+                continue;
+            }
+            std::printf("%-6ld %-12s %10.2f %12ld %12ld\n", n, name,
+                        stats.seconds, stats.peak_rss_kb,
+                        bench::text_size(object));
+        }
+
+    std::remove(object.c_str());
+    return 0;
+}
@@ -0,0 +1,140 @@
+/**
+ ** \file bench/compile.hh
+ ** \brief Helpers measuring the cost of compiling a file.
+ **/
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bench.hh"
+
+namespace bench
+{
+    /// What compiling a file cost.
+    struct compile_stats
+    {
+        /// Whether the compiler succeeded.
+        bool ok = false;
+        /// Wall clock time, in seconds.
+        double seconds = 0;
+        /// Peak RSS of the compiler, in kB.
+        long peak_rss_kb = 0;
+    };
+
+    /// Return the compiler to use, from $CXX or g++ by default.
+    inline std::string cxx()
+    {
+        const char* env = std::getenv("CXX");
+        return env && *env ? env : "g++";
+    }
+
+    /** \brief Run the command \a argv and measure it.
+     ** The command's output is discarded, and it is killed after \a
+     ** cpu_limit seconds of CPU time. */
+    inline compile_stats run_compiler(const std::vector<std::string>& argv,
+                                      long cpu_limit = 300)
+    {
+        compile_stats res;
+
+        auto start = clock::now();
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            rlimit limit = {static_cast<rlim_t>(cpu_limit),
+                            static_cast<rlim_t>(cpu_limit)};
+            setrlimit(RLIMIT_CPU, &limit);
+
+            int null = open("/dev/null", O_WRONLY);
+            dup2(null, STDOUT_FILENO);
+            dup2(null, STDERR_FILENO);
+
+            std::vector<char*> args;
+            for (const auto& arg : argv)
+                args.push_back(const_cast<char*>(arg.c_str()));
+            args.push_back(nullptr);
+            execvp(args[0], args.data());
+            _exit(127);
+        }
+
+        int status;
+        rusage usage;
+        wait4(pid, &status, 0, &usage);
+        std::chrono::duration<double> elapsed = clock::now() - start;
+
+        res.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        res.seconds = elapsed.count();
+        res.peak_rss_kb = usage.ru_maxrss;
+        return res;
+    }
+
+    /// Return the size of the code of \a object, or -1.
+    ///
+    /// Template instantiations are emitted in their own \c .text.* COMDAT
+    /// sections, they are accounted for too.
+    inline long text_size(const std::string& object)
+    {
+        std::string cmd = "size -A " + object + " 2>/dev/null";
+        FILE* out = popen(cmd.c_str(), "r");
+        if (!out)
+            return -1;
+
+        // Lines are "name size addr", and the names of the COMDAT sections
+        // of template instantiations can be thousands of characters long.
+        long res = -1;
+        std::string line;
+        char chunk[512];
+        while (std::fgets(chunk, sizeof chunk, out))
+        {
+            line += chunk;
+            if (!line.ends_with('\n'))
+                continue;
+            long size;
+            long addr;
+            auto name_end = line.find_first_of(" \t");
+            if (line.starts_with(".text") && name_end != std::string::npos
+                && std::sscanf(line.c_str() + name_end, "%ld %ld", &size,
+                               &addr)
+                    == 2)
+                res = (res < 0 ? 0 : res) + size;
+            line.clear();
+        }
+        pclose(out);
+        return res;
+    }
+
+    /// Return the number of functions defined in \a object, or -1.
+    ///
+    /// If \a weak_only, only weak ones are counted: inline functions and
+    /// template instantiations, the latter being most of them in the
+    /// examples.
+    inline long symbol_count(const std::string& object, bool weak_only = false)
+    {
+        // Only keep the symbol types, names can be very long.
+        std::string cmd =
+            "nm --defined-only " + object + " 2>/dev/null | cut -d' ' -f2";
+        FILE* out = popen(cmd.c_str(), "r");
+        if (!out)
+            return -1;
+
+        long res = 0;
+        char line[16];
+        while (std::fgets(line, sizeof line, out))
+        {
+            char type = line[0];
+            bool weak = type == 'W' || type == 'w';
+            bool text = type == 'T' || type == 't';
+            res += weak || (!weak_only && text);
+        }
+        pclose(out);
+        return res;
+    }
+
+} // namespace bench
@@ -0,0 +1,167 @@
+// DAG-aware matching benchmark: tree_automaton::match_all on every tree of a
+// hash-consed corpus, where recurring address expressions are shared, with
+// and without a misc::match_memo side table.  Matching a node is only one
+// table lookup, so the runs are repeated with rule actions costing WORK
+// iterations of a hash, as emitting code would.
+//
+// Usage: ./bench/dag [NODES] [REPEAT%] [WORK]
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "../cpp-matching-hacks/lib/hash-cons.hh"
+#include "../cpp-matching-hacks/lib/match-memo.hh"
+#include "../cpp-matching-hacks/lib/tree-automaton.hh"
+#include "bench.hh"
+#include "generator.hh"
+
+using plain::Tree;
+using misc::op;
+using misc::wild;
+
+using Automaton = misc::tree_automaton<
+    Tree::kind_count,
+    op<Tree::MEM, op<Tree::MEM, wild>>,
+    op<Tree::MEM, wild>,
+    op<Tree::MOVE, op<Tree::INT>, op<Tree::INT>>,
+    op<Tree::MOVE, op<Tree::MEM, wild>, op<Tree::MEM, wild>>,
+    op<Tree::MOVE, wild, wild>,
+    wild>;
+
+struct Node;
+using sNode = std::shared_ptr<Node>;
+
+/// A node with up to two shared children.
+struct Node
+{
+    Node(Tree::Kind kind, sNode left = nullptr, sNode right = nullptr)
+        : kind(kind)
+        , children{left, right}
+    {}
+
+    Tree::Kind kind_get() const
+    {
+        return kind;
+    }
+
+    std::size_t child_count() const
+    {
+        return kind == Tree::INT ? 0 : kind == Tree::MEM ? 1 : 2;
+    }
+
+    const Node* child_get(std::size_t i) const
+    {
+        return children[i].get();
+    }
+
+    Tree::Kind kind;
+    sNode children[2];
+};
+
+/// Interned by kind and children, or by kind and value for leaves.
+template <Tree::Kind K>
+struct KindNode : public Node
+{
+    KindNode(int)
+        : Node(K)
+    {}
+
+    KindNode(sNode exp)
+        : Node(K, exp)
+    {}
+
+    KindNode(sNode dst, sNode src)
+        : Node(K, dst, src)
+    {}
+};
+
+static sNode build(misc::hash_cons& factory, const Tree* t)
+{
+    switch (t->kind_get())
+    {
+    case Tree::INT:
+        return factory.make<KindNode<Tree::INT>>(
+            static_cast<const plain::Int*>(t)->val);
+    case Tree::MEM:
+        return factory.make<KindNode<Tree::MEM>>(
+            build(factory, t->child_get(0)));
+    default:
+        {
+            auto dst = build(factory, t->child_get(0));
+            auto src = build(factory, t->child_get(1));
+            return factory.make<KindNode<Tree::MOVE>>(dst, src);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    bench::corpus_params params;
+    params.nodes = bench::arg(argc, argv, 1, 1000000);
+    params.repeat = bench::arg(argc, argv, 2, 90) / 100.;
+    params.imm_range = 1 << 20;
+    bench::corpus corpus(params);
+
+    misc::hash_cons factory;
+    std::vector<sNode> roots;
+    for (auto root : corpus.roots_get())
+        roots.push_back(build(factory, root));
+
+    std::printf("%zu tree nodes, %zu DAG nodes, %.0f%% recurring operands\n",
+                corpus.size(), factory.size(), params.repeat * 100);
+
+    long max_work = bench::arg(argc, argv, 3, 100);
+    for (long work : {0L, max_work})
+    {
+        auto action = [work](int rule) {
+            unsigned long h = rule;
+            for (long i = 0; i < work; ++i)
+                h = (h ^ i) * 0x9e3779b97f4a7c15ull;
+            bench::do_not_optimize(h);
+        };
+
+        long tree_matches = 0;
+        long tree_sum = 0;
+        double tree_ms = bench::time_ms([&] {
+            for (const auto& root : roots)
+                tree_sum += Automaton::match_all(*root, [&](const Node&,
+                                                            int rule) {
+                    ++tree_matches;
+                    action(rule);
+                });
+        });
+
+        long dag_matches = 0;
+        long dag_sum = 0;
+        std::size_t hits;
+        double dag_ms = bench::time_ms([&] {
+            misc::match_memo<Automaton::state_type> memo;
+            misc::match_memo<Automaton::state_type>::pass pass(memo);
+            memo.reserve(factory.size());
+            for (const auto& root : roots)
+                dag_sum += Automaton::match_all(*root, pass, [&](const Node&,
+                                                                 int rule) {
+                    ++dag_matches;
+                    action(rule);
+                });
+            hits = memo.hits();
+        });
+
+        if (tree_sum != dag_sum)
+        {
+            std::printf("tree and DAG matching disagree\n");
+            return 1;
+        }
+
+        std::printf("actions of %ld iterations, %.1f%% redundant matches "
+                    "avoided\n",
+                    work, 100. * (tree_matches - dag_matches) / tree_matches);
+        std::printf("%-24s %10.2f ms %10ld matches\n", "tree matching",
+                    tree_ms, tree_matches);
+        std::printf("%-24s %10.2f ms %10ld matches %10zu memo hits\n",
+                    "DAG matching", dag_ms, dag_matches, hits);
+    }
+
+    return 0;
+}
@@ -0,0 +1,231 @@
+// Deep tree benchmark: printing and matching DEPTH deep chains, a Mem chain
+// Mem(Mem(...Mem(0)...)) and a Move spine Move(0,Move(1,...)), with the
+// recursive traverse() and tree_automaton::match_all against the iterative
+// driver of match-tree-iterative.cc, a preallocated misc::walker.
+//
+// The recursion takes one call frame per level: chains much deeper than the
+// default overflow the call stack, while the walker only needs memory.
+//
+// Usage: ./bench/deep [DEPTH] [ROUNDS]
+
+#include <charconv>
+#include <cstdio>
+#include <string>
+
+#include "../cpp-matching-hacks/lib/arena.hh"
+#include "../cpp-matching-hacks/lib/tree-automaton.hh"
+#include "../cpp-matching-hacks/lib/walk.hh"
+#include "bench.hh"
+
+static void print_int(std::string& out, int val)
+{
+    char buf[16];
+    auto res = std::to_chars(buf, buf + sizeof buf, val);
+    out.append(buf, res.ptr);
+}
+
+/// The tree of match-tree-iterative.cc, printing into a string, with nodes
+/// allocated in an arena: destroying a deep chain of std::shared_ptr would
+/// recurse as well.
+struct Tree
+{
+    enum Kind
+    {
+        INT,
+        MEM,
+        MOVE,
+    };
+
+    static constexpr std::size_t kind_count = 3;
+
+    Tree(Kind kind)
+        : kind(kind)
+    {}
+
+    virtual void traverse(std::string& out) const = 0;
+
+    Kind kind_get() const
+    {
+        return kind;
+    }
+
+    std::size_t child_count() const
+    {
+        return kind == INT ? 0 : kind == MEM ? 1 : 2;
+    }
+
+    const Tree* child_get(std::size_t i) const;
+
+    const Kind kind;
+};
+
+struct Int : public Tree
+{
+    Int(int val)
+        : Tree(INT)
+        , val(val)
+    {}
+
+    virtual void traverse(std::string& out) const override
+    {
+        print_int(out, val);
+    }
+
+    int val;
+};
+
+struct Mem : public Tree
+{
+    Mem(const Tree* exp)
+        : Tree(MEM)
+        , exp(exp)
+    {}
+
+    virtual void traverse(std::string& out) const override
+    {
+        out += "Mem(";
+        exp->traverse(out);
+        out += ")";
+    }
+
+    const Tree* exp;
+};
+
+struct Move : public Tree
+{
+    Move(const Tree* dst, const Tree* src)
+        : Tree(MOVE)
+        , dst(dst)
+        , src(src)
+    {}
+
+    virtual void traverse(std::string& out) const override
+    {
+        out += "Move(";
+        dst->traverse(out);
+        out += ",";
+        src->traverse(out);
+        out += ")";
+    }
+
+    const Tree* dst;
+    const Tree* src;
+};
+
+const Tree* Tree::child_get(std::size_t i) const
+{
+    if (kind == MEM)
+        return static_cast<const Mem*>(this)->exp;
+    return i == 0 ? static_cast<const Move*>(this)->dst
+                  : static_cast<const Move*>(this)->src;
+}
+
+using misc::op;
+using misc::wild;
+
+using Automaton = misc::tree_automaton<
+    Tree::kind_count,
+    op<Tree::MEM, op<Tree::MEM, wild>>,
+    op<Tree::MEM, wild>,
+    op<Tree::MOVE, op<Tree::INT>, op<Tree::INT>>,
+    op<Tree::MOVE, op<Tree::MEM, wild>, op<Tree::MEM, wild>>,
+    op<Tree::MOVE, wild, wild>,
+    wild>;
+
+using state_type = Automaton::state_type;
+
+/// The iterative driver: print and match in one walk.
+struct Driver
+{
+    void pre(const Tree& t)
+    {
+        if (t.kind_get() == Tree::MEM)
+            out += "Mem(";
+        else if (t.kind_get() == Tree::MOVE)
+            out += "Move(";
+    }
+
+    void in(const Tree&, std::size_t)
+    {
+        out += ",";
+    }
+
+    state_type post(const Tree& t, const state_type* children)
+    {
+        if (t.kind_get() == Tree::INT)
+            print_int(out, static_cast<const Int&>(t).val);
+        else
+            out += ")";
+
+        std::size_t arity = t.child_count();
+        state_type res = Automaton::state(t.kind_get(),
+                                          arity > 0 ? children[0] : 0,
+                                          arity > 1 ? children[1] : 0);
+        rules += Automaton::rule(res);
+        return res;
+    }
+
+    std::string& out;
+    long& rules;
+};
+
+/// Print and match \a root \a rounds times both ways, return false if they
+/// disagree.
+static bool run(const char* name, const Tree& root, long depth, long rounds)
+{
+    std::string recursive_out;
+    std::string iterative_out;
+    long recursive_rules = 0;
+    long iterative_rules = 0;
+
+    double recursive_ms = bench::time_ms([&] {
+        for (long r = 0; r < rounds; ++r)
+        {
+            recursive_out.clear();
+            root.traverse(recursive_out);
+            Automaton::match_all(
+                root, [&](const Tree&, int rule) { recursive_rules += rule; });
+        }
+    });
+
+    misc::walker<Tree, state_type> walker;
+    walker.reserve(depth);
+    double iterative_ms = bench::time_ms([&] {
+        for (long r = 0; r < rounds; ++r)
+        {
+            iterative_out.clear();
+            walker(root, Driver{iterative_out, iterative_rules});
+        }
+    });
+
+    std::printf("%s, %ld levels\n", name, depth);
+    std::printf("  %-22s %10.2f ms %8.2f ns/level\n", "recursive", recursive_ms,
+                recursive_ms * 1e6 / (rounds * depth));
+    std::printf("  %-22s %10.2f ms %8.2f ns/level\n", "iterative",
+                iterative_ms, iterative_ms * 1e6 / (rounds * depth));
+    return recursive_out == iterative_out
+        && recursive_rules == iterative_rules;
+}
+
+int main(int argc, char* argv[])
+{
+    long depth = bench::arg(argc, argv, 1, 100000);
+    long rounds = bench::arg(argc, argv, 2, 100);
+
+    misc::arena arena;
+    const Tree* chain = arena.make<Int>(0);
+    const Tree* spine = arena.make<Int>(0);
+    for (long i = 0; i < depth; ++i)
+    {
+        chain = arena.make<Mem>(chain);
+        spine = arena.make<Move>(arena.make<Int>(i), spine);
+    }
+
+    if (!run("Mem chain", *chain, depth, rounds)
+        || !run("Move spine", *spine, depth, rounds))
+    {
+        std::printf("recursive and iterative drivers disagree\n");
+        return 1;
+    }
+    return 0;
+}
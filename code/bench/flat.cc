@@ -0,0 +1,117 @@
+// Layout benchmark: the pointer-based tree of the corpus against the same
+// forest stored in a misc::flat_tree, on a traversal summing the immediates
+// and on tree_automaton matching (match_all against match_flat).
+//
+// Usage: ./bench/flat [NODES]
+
+#include <cstdio>
+#include <vector>
+
+#include "../cpp-matching-hacks/lib/flat-tree.hh"
+#include "../cpp-matching-hacks/lib/tree-automaton.hh"
+#include "bench.hh"
+#include "generator.hh"
+
+using namespace plain;
+using misc::flat_tree;
+using misc::op;
+using misc::wild;
+
+using Automaton = misc::tree_automaton<
+    Tree::kind_count,
+    op<Tree::MEM, op<Tree::MEM, wild>>,
+    op<Tree::MEM, wild>,
+    op<Tree::MOVE, op<Tree::INT>, op<Tree::INT>>,
+    op<Tree::MOVE, op<Tree::MEM, wild>, op<Tree::MEM, wild>>,
+    op<Tree::MOVE, wild, wild>,
+    wild>;
+
+static flat_tree::index_type flatten(flat_tree& res, const Tree* t)
+{
+    switch (t->kind_get())
+    {
+    case Tree::INT:
+        return res.add_leaf(Tree::INT, static_cast<const Int*>(t)->val);
+    case Tree::MEM:
+        return res.add_node(Tree::MEM, {flatten(res, t->child_get(0))});
+    default:
+        {
+            auto dst = flatten(res, t->child_get(0));
+            auto src = flatten(res, t->child_get(1));
+            return res.add_node(Tree::MOVE, {dst, src});
+        }
+    }
+}
+
+static long sum(const Tree* t)
+{
+    if (t->kind_get() == Tree::INT)
+        return static_cast<const Int*>(t)->val;
+    long res = 0;
+    for (std::size_t i = 0; i < t->child_count(); ++i)
+        res += sum(t->child_get(i));
+    return res;
+}
+
+int main(int argc, char* argv[])
+{
+    bench::corpus_params params;
+    params.nodes = bench::arg(argc, argv, 1, 1000000);
+    bench::corpus corpus(params);
+
+    flat_tree flat;
+    flat.reserve(corpus.size(), corpus.size());
+    for (auto root : corpus.roots_get())
+        flatten(flat, root);
+
+    long ptr_sum = 0;
+    double ptr_sum_ms = bench::time_ms([&] {
+        for (auto root : corpus.roots_get())
+            ptr_sum += sum(root);
+    });
+
+    // Immediates are leaves: no need to walk the trees.
+    long flat_sum = 0;
+    double flat_sum_ms = bench::time_ms([&] {
+        for (flat_tree::index_type i = 0; i < flat.size(); ++i)
+            if (flat.kind_get(i) == Tree::INT)
+                flat_sum += flat.imm_get(i);
+    });
+
+    long ptr_hits = 0;
+    double ptr_match_ms = bench::time_ms([&] {
+        for (auto root : corpus.roots_get())
+            Automaton::match_all(*root, [&](const Tree&, int rule) {
+                ptr_hits += rule;
+            });
+    });
+
+    long flat_hits = 0;
+    std::vector<Automaton::state_type> states;
+    double flat_match_ms = bench::time_ms([&] {
+        Automaton::match_flat(flat, states, [&](flat_tree::index_type,
+                                                int rule) {
+            flat_hits += rule;
+        });
+    });
+
+    if (ptr_sum != flat_sum || ptr_hits != flat_hits)
+    {
+        std::printf("pointer and flat trees disagree\n");
+        return 1;
+    }
+
+    std::size_t n = corpus.size();
+    std::printf("%zu nodes, %.1f bytes/node in the flat tree\n", n,
+                double(flat.memory()) / n);
+    std::printf("%-24s %10.2f ms %8.2f ns/node\n", "pointer sum", ptr_sum_ms,
+                ptr_sum_ms * 1e6 / n);
+    std::printf("%-24s %10.2f ms %8.2f ns/node\n", "flat sum", flat_sum_ms,
+                flat_sum_ms * 1e6 / n);
+    std::printf("%-24s %10.2f ms %8.2f ns/node\n", "pointer match_all",
+                ptr_match_ms, ptr_match_ms * 1e6 / n);
+    std::printf("%-24s %10.2f ms %8.2f ns/node\n", "flat match_flat",
+                flat_match_ms, flat_match_ms * 1e6 / n);
+
+    return 0;
+}
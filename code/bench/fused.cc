@@ -0,0 +1,147 @@
+// Fused walk benchmark: printing and matching every tree of a synthetic corpus
+// in two passes, a recursive std::visit printer then
+// tree_automaton::match_all, against a single misc::walk doing both.
+//
+// Both sides print into the same kind of buffer and emit the rule of every
+// node, their outputs are compared.
+//
+// Usage: ./bench/fused [NODES] [MAX_DEPTH]
+
+#include <charconv>
+#include <cstdio>
+#include <string>
+#include <variant>
+
+#include "../cpp-matching-hacks/lib/tree-automaton.hh"
+#include "../cpp-matching-hacks/lib/walk.hh"
+#include "bench.hh"
+#include "generator.hh"
+
+using namespace plain;
+using misc::op;
+using misc::wild;
+
+using Automaton = misc::tree_automaton<
+    Tree::kind_count,
+    op<Tree::MEM, op<Tree::MEM, wild>>,
+    op<Tree::MEM, wild>,
+    op<Tree::MOVE, op<Tree::INT>, op<Tree::INT>>,
+    op<Tree::MOVE, op<Tree::MEM, wild>, op<Tree::MEM, wild>>,
+    op<Tree::MOVE, wild, wild>,
+    wild>;
+
+using state_type = Automaton::state_type;
+
+static void print_int(std::string& out, int val)
+{
+    char buf[16];
+    auto res = std::to_chars(buf, buf + sizeof buf, val);
+    out.append(buf, res.ptr);
+}
+
+/// The first pass of the two-pass side: a recursive printer.
+struct Printer
+{
+    void operator()(Int* i)
+    {
+        print_int(out, i->val);
+    }
+
+    void operator()(Mem* m)
+    {
+        out += "Mem(";
+        std::visit(*this, m->exp->variant());
+        out += ")";
+    }
+
+    void operator()(Move* m)
+    {
+        out += "Move(";
+        std::visit(*this, m->dst->variant());
+        out += ",";
+        std::visit(*this, m->src->variant());
+        out += ")";
+    }
+
+    std::string& out;
+};
+
+/// The fused side: print and match in the same walk.
+struct Selector
+{
+    void pre(const Tree& t)
+    {
+        if (t.kind_get() == Tree::MEM)
+            out += "Mem(";
+        else if (t.kind_get() == Tree::MOVE)
+            out += "Move(";
+    }
+
+    void in(const Tree&, std::size_t)
+    {
+        out += ",";
+    }
+
+    state_type post(const Tree& t, const state_type* children)
+    {
+        if (t.kind_get() == Tree::INT)
+            print_int(out, static_cast<const Int&>(t).val);
+        else
+            out += ")";
+
+        std::size_t arity = t.child_count();
+        state_type res = Automaton::state(t.kind_get(),
+                                          arity > 0 ? children[0] : 0,
+                                          arity > 1 ? children[1] : 0);
+        rules += Automaton::rule(res);
+        return res;
+    }
+
+    std::string& out;
+    long& rules;
+};
+
+int main(int argc, char* argv[])
+{
+    bench::corpus_params params;
+    params.nodes = bench::arg(argc, argv, 1, 1000000);
+    params.max_depth = bench::arg(argc, argv, 2, 6);
+    bench::corpus corpus(params);
+    const auto& roots = corpus.roots_get();
+
+    std::string two_pass_out;
+    std::string fused_out;
+    two_pass_out.reserve(16 * corpus.size());
+    fused_out.reserve(16 * corpus.size());
+
+    long two_pass_rules = 0;
+    double two_pass_ms = bench::time_ms([&] {
+        for (auto t : roots)
+        {
+            std::visit(Printer{two_pass_out}, t->variant());
+            Automaton::match_all(
+                *t, [&](const Tree&, int rule) { two_pass_rules += rule; });
+        }
+    });
+
+    long fused_rules = 0;
+    double fused_ms = bench::time_ms([&] {
+        Selector selector{fused_out, fused_rules};
+        misc::walker<Tree, state_type> walker;
+        for (auto t : roots)
+            walker(*t, selector);
+    });
+
+    if (two_pass_out != fused_out || two_pass_rules != fused_rules)
+    {
+        std::printf("two-pass and fused walks disagree\n");
+        return 1;
+    }
+
+    std::printf("%zu nodes, %zu statements\n", corpus.size(), roots.size());
+    std::printf("%-24s %10.2f ms %8.2f ns/node\n", "print, then match",
+                two_pass_ms, two_pass_ms * 1e6 / corpus.size());
+    std::printf("%-24s %10.2f ms %8.2f ns/node\n", "fused misc::walk",
+                fused_ms, fused_ms * 1e6 / corpus.size());
+    return 0;
+}
@@ -0,0 +1,172 @@
+/**
+ ** \file bench/generator.hh
+ ** \brief Synthetic IR corpora for the benchmarks.
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include "../cpp-matching-hacks/lib/arena.hh"
+#include "tree-plain.hh"
+
+namespace bench
+{
+    /// Parameters of a synthetic corpus.
+    struct corpus_params
+    {
+        /// Number of nodes to generate, roughly.
+        std::size_t nodes = 1000000;
+        /// Maximum depth of a statement, raised to 1 if it is 0.
+        unsigned max_depth = 6;
+        /// Seed of the generator, the same seed gives the same corpus.
+        unsigned seed = 42;
+        /// Immediates are in [0, imm_range).
+        unsigned imm_range = 64;
+        /// Probability that an operand of a statement is one of \a
+        /// repeat_pool recurring address expressions, generated again each
+        /// time: they are equal but do not share nodes.
+        double repeat = 0;
+        unsigned repeat_pool = 256;
+        /// Probability that an operand of a statement is an operand of one
+        /// of the \a share_window previous statements: they share nodes,
+        /// and the corpus is a DAG.
+        double sharing = 0;
+        unsigned share_window = 64;
+        /// Probability that a statement is a `Move`, rather than an `exp`.
+        double move_ratio = 0.8;
+        /// Probability that an inner expression is a `Move(exp, exp)`,
+        /// rather than a `Mem(exp)`: the fan-out of expressions.
+        double fanout = 0;
+
+        /// How expression depths are distributed.
+        enum class distribution
+        {
+            /// Each level is a leaf with probability \a leaf_probability.
+            geometric,
+            /// Expression depths are uniform up to \a max_depth.
+            uniform,
+        };
+        distribution depth = distribution::geometric;
+        double leaf_probability = 0.5;
+    };
+
+    /// A forest of random statements, `Move(exp, exp)` or `exp`, where
+    /// expressions are `Int`, `Mem(exp)` or `Move(exp, exp)` of random
+    /// depth.  Statement operands may be taken from a pool of recurring
+    /// expressions, or shared with previous statements.
+    class corpus
+    {
+    public:
+        corpus(const corpus_params& params = {});
+
+        corpus(const corpus&) = delete;
+        corpus& operator=(const corpus&) = delete;
+
+        /// The roots of the statements.
+        const std::vector<plain::Tree*>& roots_get() const
+        {
+            return roots_;
+        }
+
+        /// The number of distinct nodes.
+        std::size_t size() const
+        {
+            return size_;
+        }
+
+    private:
+        plain::Tree* make_stmt();
+        plain::Tree* make_operand();
+        plain::Tree* make_exp(unsigned depth, unsigned leaf_depth,
+                              std::mt19937& rng);
+        unsigned leaf_depth(unsigned depth, std::mt19937& rng);
+
+        corpus_params params_;
+        std::mt19937 rng_;
+        misc::arena arena_;
+        std::vector<plain::Tree*> roots_;
+        /// The latest operands, for sharing.
+        std::vector<plain::Tree*> operands_;
+        std::size_t size_ = 0;
+    };
+
+    inline corpus::corpus(const corpus_params& params)
+        : params_(params)
+        , rng_(params.seed)
+    {
+        // leaf_depth() would wrap max_depth - 1, and lift the depth cap
+        params_.max_depth = std::max(params_.max_depth, 1u);
+        while (size_ < params_.nodes)
+            roots_.push_back(make_stmt());
+    }
+
+    inline plain::Tree* corpus::make_stmt()
+    {
+        if (std::bernoulli_distribution(params_.move_ratio)(rng_))
+        {
+            ++size_;
+            auto dst = make_operand();
+            auto src = make_operand();
+            return arena_.make<plain::Move>(dst, src);
+        }
+        return make_exp(0, leaf_depth(0, rng_), rng_);
+    }
+
+    inline plain::Tree* corpus::make_operand()
+    {
+        if (params_.sharing > 0 && !operands_.empty()
+            && std::bernoulli_distribution(params_.sharing)(rng_))
+            return operands_[rng_() % operands_.size()];
+
+        plain::Tree* res;
+        if (params_.repeat > 0
+            && std::bernoulli_distribution(params_.repeat)(rng_))
+        {
+            // The same seed generates the same expression.
+            std::mt19937 rng(params_.seed + 1 + rng_() % params_.repeat_pool);
+            res = make_exp(1, leaf_depth(1, rng), rng);
+        }
+        else
+            res = make_exp(1, leaf_depth(1, rng_), rng_);
+
+        if (params_.sharing > 0)
+        {
+            if (operands_.size() < params_.share_window)
+                operands_.push_back(res);
+            else
+                operands_[rng_() % operands_.size()] = res;
+        }
+        return res;
+    }
+
+    inline unsigned corpus::leaf_depth(unsigned depth, std::mt19937& rng)
+    {
+        unsigned max = std::max(depth, params_.max_depth - 1);
+        if (params_.depth == corpus_params::distribution::uniform)
+            return std::uniform_int_distribution<unsigned>(depth, max)(rng);
+        return max;
+    }
+
+    inline plain::Tree* corpus::make_exp(unsigned depth, unsigned leaf_depth,
+                                         std::mt19937& rng)
+    {
+        ++size_;
+        if (depth >= leaf_depth
+            || (params_.depth == corpus_params::distribution::geometric
+                && std::bernoulli_distribution(params_.leaf_probability)(rng)))
+            return arena_.make<plain::Int>(rng() % params_.imm_range);
+        if (params_.fanout > 0
+            && std::bernoulli_distribution(params_.fanout)(rng))
+        {
+            auto dst = make_exp(depth + 1, leaf_depth, rng);
+            auto src = make_exp(depth + 1, leaf_depth, rng);
+            return arena_.make<plain::Move>(dst, src);
+        }
+        return arena_.make<plain::Mem>(make_exp(depth + 1, leaf_depth, rng));
+    }
+
+} // namespace bench
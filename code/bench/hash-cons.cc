@@ -0,0 +1,220 @@
+// Hash-consing benchmark: building a corpus with recurring address
+// expressions through misc::hash_cons against plain allocations, and
+// comparing its statements, deeply or by pointer.  Immediates are drawn
+// from a large range, so that most of the sharing comes from the recurring
+// expressions.
+//
+// Statements are compared with their copies, a second build of them, and
+// with their neighbours, which they are almost never equal to.
+//
+// Usage: ./bench/hash-cons [NODES] [REPEAT%]
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "../cpp-matching-hacks/lib/hash-cons.hh"
+#include "bench.hh"
+#include "generator.hh"
+
+using plain::Tree;
+
+struct Node
+{
+    Node(Tree::Kind kind)
+        : kind(kind)
+    {}
+
+    virtual ~Node() = default;
+
+    Tree::Kind kind;
+};
+
+using sNode = std::shared_ptr<Node>;
+
+struct Int : public Node
+{
+    Int(int val)
+        : Node(Tree::INT)
+        , val(val)
+    {}
+
+    int val;
+};
+
+struct Mem : public Node
+{
+    Mem(sNode exp)
+        : Node(Tree::MEM)
+        , exp(exp)
+    {}
+
+    sNode exp;
+};
+
+struct Move : public Node
+{
+    Move(sNode dst, sNode src)
+        : Node(Tree::MOVE)
+        , dst(dst)
+        , src(src)
+    {}
+
+    sNode dst;
+    sNode src;
+};
+
+/// Build \a t with new nodes.
+static sNode build(const Tree* t)
+{
+    switch (t->kind_get())
+    {
+    case Tree::INT:
+        return sNode(new Int(static_cast<const plain::Int*>(t)->val));
+    case Tree::MEM:
+        return sNode(new Mem(build(t->child_get(0))));
+    default:
+        return sNode(new Move(build(t->child_get(0)), build(t->child_get(1))));
+    }
+}
+
+/// Build \a t with \a factory.
+static sNode build(misc::hash_cons& factory, const Tree* t)
+{
+    switch (t->kind_get())
+    {
+    case Tree::INT:
+        return factory.make<Int>(static_cast<const plain::Int*>(t)->val);
+    case Tree::MEM:
+        return factory.make<Mem>(build(factory, t->child_get(0)));
+    default:
+        {
+            auto dst = build(factory, t->child_get(0));
+            auto src = build(factory, t->child_get(1));
+            return factory.make<Move>(dst, src);
+        }
+    }
+}
+
+static bool equal(const Node* a, const Node* b)
+{
+    if (a->kind != b->kind)
+        return false;
+    switch (a->kind)
+    {
+    case Tree::INT:
+        return static_cast<const Int*>(a)->val
+            == static_cast<const Int*>(b)->val;
+    case Tree::MEM:
+        return equal(static_cast<const Mem*>(a)->exp.get(),
+                     static_cast<const Mem*>(b)->exp.get());
+    default:
+        {
+            auto ma = static_cast<const Move*>(a);
+            auto mb = static_cast<const Move*>(b);
+            return equal(ma->dst.get(), mb->dst.get())
+                && equal(ma->src.get(), mb->src.get());
+        }
+    }
+}
+
+/// Count the statements of \a as equal to the statement of \a bs \a
+/// distance statements before.
+template <typename Eq>
+static long count_equal(const std::vector<sNode>& as,
+                        const std::vector<sNode>& bs, std::size_t distance,
+                        Eq eq)
+{
+    long res = 0;
+    for (std::size_t i = distance; i < as.size(); ++i)
+        res += eq(bs[i - distance].get(), as[i].get());
+    return res;
+}
+
+static bool same(const Node* a, const Node* b)
+{
+    return a == b;
+}
+
+/// Compare \a as with \a bs at each of \a distances, deeply, and by pointer
+/// for their hash-consed \a shared_as and \a shared_bs.
+static bool compare(const char* name, const std::vector<sNode>& as,
+                    const std::vector<sNode>& bs,
+                    const std::vector<sNode>& shared_as,
+                    const std::vector<sNode>& shared_bs,
+                    const std::vector<std::size_t>& distances)
+{
+    long deep = 0;
+    double deep_ms = bench::time_ms([&] {
+        for (auto d : distances)
+            deep += count_equal(as, bs, d, equal);
+    });
+    long shallow = 0;
+    double shallow_ms = bench::time_ms([&] {
+        for (auto d : distances)
+            shallow += count_equal(shared_as, shared_bs, d, same);
+    });
+    if (deep != shallow)
+    {
+        std::printf("deep and pointer equality disagree\n");
+        return false;
+    }
+
+    std::size_t compares = distances.size() * as.size();
+    std::printf("%-10s %-13s %10.2f ms %8.2f ns/compare (%ld equal)\n", name,
+                "deep", deep_ms, deep_ms * 1e6 / compares, deep);
+    std::printf("%-10s %-13s %10.2f ms %8.2f ns/compare\n", name, "pointer",
+                shallow_ms, shallow_ms * 1e6 / compares);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    bench::corpus_params params;
+    params.nodes = bench::arg(argc, argv, 1, 1000000);
+    params.repeat = bench::arg(argc, argv, 2, 50) / 100.;
+    params.imm_range = 1 << 20;
+    bench::corpus corpus(params);
+
+    auto build_all = [&] {
+        std::vector<sNode> res;
+        for (auto root : corpus.roots_get())
+            res.push_back(build(root));
+        return res;
+    };
+    auto build_all_hash_cons = [&](misc::hash_cons& factory) {
+        std::vector<sNode> res;
+        for (auto root : corpus.roots_get())
+            res.push_back(build(factory, root));
+        return res;
+    };
+
+    std::printf("%zu nodes, %.0f%% recurring operands\n", corpus.size(),
+                params.repeat * 100);
+    bench::isolated("new", [&] { bench::do_not_optimize(build_all()); });
+    bench::isolated("hash_cons", [&] {
+        misc::hash_cons factory;
+        bench::do_not_optimize(build_all_hash_cons(factory));
+    });
+
+    misc::hash_cons factory;
+    auto roots = build_all();
+    auto shared_roots = build_all_hash_cons(factory);
+    std::printf("%zu distinct nodes, dedup ratio %.2f\n", factory.size(),
+                double(factory.requests()) / factory.size());
+
+    // A second build, of equal trees: the same nodes for hash_cons
+    auto copies = build_all();
+    auto shared_copies = build_all_hash_cons(factory);
+
+    // Statements and their copies, as many times as their 8 neighbours
+    std::vector<std::size_t> copy_distances(8, 0);
+    std::vector<std::size_t> neighbour_distances = {1, 2, 3, 4, 5, 6, 7, 8};
+    if (!compare("copies", roots, copies, shared_roots, shared_copies,
+                 copy_distances)
+        || !compare("neighbours", roots, roots, shared_roots, shared_roots,
+                    neighbour_distances))
+        return 1;
+
+    return 0;
+}
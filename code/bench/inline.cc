@@ -0,0 +1,355 @@
+// Inline leaf benchmark: the trees of a synthetic corpus as heap allocated
+// polymorphic nodes behind std::shared_ptr, where every Int is a node, and as
+// the closed nodes of match-tree-inline.cc, where Int leaves are stored in
+// their parent's misc::tagged_child slot and only interior nodes are
+// allocated, one by one on the heap or in a misc::arena.
+//
+// Allocations are counted by replacing the global operator new, and every
+// node of every tree is then matched.
+//
+// Usage: ./bench/inline [NODES] [MAX_DEPTH]
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "../cpp-matching-hacks/lib/arena.hh"
+#include "../cpp-matching-hacks/lib/tagged-child.hh"
+#include "bench.hh"
+#include "generator.hh"
+
+static long allocations = 0;
+static long allocated_bytes = 0;
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    allocated_bytes += size;
+    if (void* res = std::malloc(size))
+        return res;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+/// The rules of every matcher.
+enum Rule
+{
+    INT,
+    MEM_MEM,
+    MEM,
+    MOVE,
+    RULE_COUNT,
+};
+
+using hits_type = std::array<long, RULE_COUNT>;
+
+/*---------------------.
+| Heap allocated Int.  |
+`---------------------*/
+
+namespace boxed
+{
+    struct Tree
+    {
+        enum Kind
+        {
+            INT,
+            MEM,
+            MOVE,
+        };
+
+        Tree(Kind kind)
+            : kind(kind)
+        {}
+
+        virtual ~Tree() = default;
+
+        const Kind kind;
+    };
+
+    using sTree = std::shared_ptr<Tree>;
+
+    struct Int : public Tree
+    {
+        Int(int val)
+            : Tree(INT)
+            , val(val)
+        {}
+
+        int val;
+    };
+
+    struct Mem : public Tree
+    {
+        Mem(sTree exp)
+            : Tree(MEM)
+            , exp(exp)
+        {}
+
+        sTree exp;
+    };
+
+    struct Move : public Tree
+    {
+        Move(sTree dst, sTree src)
+            : Tree(MOVE)
+            , dst(dst)
+            , src(src)
+        {}
+
+        sTree dst;
+        sTree src;
+    };
+
+    static sTree build(const plain::Tree* t)
+    {
+        switch (t->kind_get())
+        {
+        case plain::Tree::INT:
+            return std::make_shared<Int>(
+                static_cast<const plain::Int*>(t)->val);
+        case plain::Tree::MEM:
+            return std::make_shared<Mem>(build(t->child_get(0)));
+        default:
+            return std::make_shared<Move>(build(t->child_get(0)),
+                                          build(t->child_get(1)));
+        }
+    }
+
+    static void match_all(const Tree* t, hits_type& hits)
+    {
+        switch (t->kind)
+        {
+        case Tree::INT:
+            ++hits[INT];
+            break;
+        case Tree::MEM:
+            {
+                auto exp = static_cast<const Mem*>(t)->exp.get();
+                match_all(exp, hits);
+                ++hits[exp->kind == Tree::MEM ? MEM_MEM : MEM];
+            }
+            break;
+        case Tree::MOVE:
+            match_all(static_cast<const Move*>(t)->dst.get(), hits);
+            match_all(static_cast<const Move*>(t)->src.get(), hits);
+            ++hits[MOVE];
+            break;
+        }
+    }
+} // namespace boxed
+
+/*-------------.
+| Inline Int.  |
+`-------------*/
+
+namespace tagged
+{
+    struct Tree;
+
+    using child = misc::tagged_child<Tree>;
+
+    struct Tree
+    {
+        enum Kind
+        {
+            MEM,
+            MOVE,
+        };
+
+        Tree(Kind kind)
+            : kind(kind)
+        {}
+
+        const Kind kind;
+    };
+
+    struct Mem final : public Tree
+    {
+        Mem(child exp)
+            : Tree(MEM)
+            , exp(exp)
+        {}
+
+        child exp;
+    };
+
+    struct Move final : public Tree
+    {
+        Move(child dst, child src)
+            : Tree(MOVE)
+            , dst(dst)
+            , src(src)
+        {}
+
+        child dst;
+        child src;
+    };
+
+    /// Interior nodes allocated one by one, like misc::arena::make.
+    class heap
+    {
+    public:
+        heap(std::size_t n)
+        {
+            nodes_.reserve(n);
+        }
+
+        heap(const heap&) = delete;
+        heap& operator=(const heap&) = delete;
+
+        ~heap()
+        {
+            for (void* p : nodes_)
+                ::operator delete(p);
+        }
+
+        template <typename T, typename... Args>
+        T* make(Args&&... args)
+        {
+            static_assert(std::is_trivially_destructible_v<T>);
+            void* p = ::operator new(sizeof(T));
+            nodes_.push_back(p);
+            return new (p) T(std::forward<Args>(args)...);
+        }
+
+    private:
+        std::vector<void*> nodes_;
+    };
+
+    /// Build \a t, its interior nodes being allocated by \a alloc.
+    template <typename Alloc>
+    child build(Alloc& alloc, const plain::Tree* t)
+    {
+        switch (t->kind_get())
+        {
+        case plain::Tree::INT:
+            return static_cast<const plain::Int*>(t)->val;
+        case plain::Tree::MEM:
+            return alloc.template make<Mem>(build(alloc, t->child_get(0)));
+        default:
+            {
+                auto dst = build(alloc, t->child_get(0));
+                auto src = build(alloc, t->child_get(1));
+                return alloc.template make<Move>(dst, src);
+            }
+        }
+    }
+
+    static void match_all(child c, hits_type& hits)
+    {
+        if (c.is_imm())
+        {
+            ++hits[INT];
+            return;
+        }
+        const Tree* t = c.node_get();
+        if (t->kind == Tree::MEM)
+        {
+            child exp = static_cast<const Mem*>(t)->exp;
+            match_all(exp, hits);
+            ++hits[!exp.is_imm() && exp.node_get()->kind == Tree::MEM
+                       ? MEM_MEM
+                       : MEM];
+        }
+        else
+        {
+            match_all(static_cast<const Move*>(t)->dst, hits);
+            match_all(static_cast<const Move*>(t)->src, hits);
+            ++hits[MOVE];
+        }
+    }
+} // namespace tagged
+
+/// Run \a build, then \a match, and report their costs.
+template <typename B, typename M>
+static hits_type run(const char* name, B build, M match)
+{
+    long allocs = allocations;
+    long bytes = allocated_bytes;
+    double build_ms = bench::time_ms(build);
+    allocs = allocations - allocs;
+    bytes = allocated_bytes - bytes;
+
+    hits_type hits = {};
+    double match_ms = bench::time_ms([&] { match(hits); });
+    std::printf("%-20s %10ld allocs %10ld kB %8.2f ms build %8.2f ms match\n",
+                name, allocs, bytes / 1024, build_ms, match_ms);
+    return hits;
+}
+
+int main(int argc, char* argv[])
+{
+    // Immediates may be negative, make sure they survive their tagging.
+    for (int imm : {0, 1, -1, 1 << 30, -(1 << 30) - 1})
+        if (tagged::child(imm).imm_get() != imm)
+        {
+            std::printf("immediate %d is not preserved\n", imm);
+            return 1;
+        }
+
+    bench::corpus_params params;
+    params.nodes = bench::arg(argc, argv, 1, 1000000);
+    params.max_depth = bench::arg(argc, argv, 2, 6);
+    bench::corpus corpus(params);
+    const auto& roots = corpus.roots_get();
+    std::printf("%zu nodes, %zu statements\n", corpus.size(), roots.size());
+
+    std::vector<boxed::sTree> boxed_roots;
+    boxed_roots.reserve(roots.size());
+    auto boxed_hits = run(
+        "heap Int",
+        [&] {
+            for (auto t : roots)
+                boxed_roots.push_back(boxed::build(t));
+        },
+        [&](hits_type& hits) {
+            for (const auto& t : boxed_roots)
+                boxed::match_all(t.get(), hits);
+        });
+
+    auto run_tagged = [&](const char* name, auto& alloc) {
+        std::vector<tagged::child> tagged_roots;
+        tagged_roots.reserve(roots.size());
+        return run(
+            name,
+            [&] {
+                for (auto t : roots)
+                    tagged_roots.push_back(tagged::build(alloc, t));
+            },
+            [&](hits_type& hits) {
+                for (auto t : tagged_roots)
+                    tagged::match_all(t, hits);
+            });
+    };
+
+    tagged::heap heap(corpus.size());
+    auto heap_hits = run_tagged("inline Int, heap", heap);
+    misc::arena arena;
+    auto tagged_hits = run_tagged("inline Int, arena", arena);
+
+    if (boxed_hits != heap_hits || boxed_hits != tagged_hits)
+    {
+        std::printf("heap and inline Int matching disagree\n");
+        return 1;
+    }
+    std::printf("%ld of %zu nodes are leaves\n", boxed_hits[INT],
+                corpus.size());
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+// Input of bench/compile-lambda: visit a variant of shared pointers to ALTS
+// node types with a matcher handling the first one and a catch-all, either:
+// - MODE 0: a struct whose catch-all takes auto, as the Matchers of the
+//   examples, visited with std::visit;
+// - MODE 1: the same with a catch-all taking the base of the nodes;
+// - MODE 2: a misc::LambdaVisitor with the same catch-all, visited with
+//   misc::visit.
+
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <variant>
+
+#include "../../cpp-matching-hacks/lib/lambda-visitor.hh"
+#include "../../cpp-matching-hacks/lib/visit.hh"
+
+#ifndef ALTS
+#    define ALTS 8
+#endif
+
+#ifndef MODE
+#    define MODE 0
+#endif
+
+struct base
+{
+    virtual ~base() = default;
+    virtual int kind() const = 0;
+};
+
+template <std::size_t I>
+struct node : base
+{
+    int kind() const override
+    {
+        return I;
+    }
+};
+
+using sBase = std::shared_ptr<base>;
+
+template <std::size_t... I>
+std::variant<std::shared_ptr<node<I>>...> make_variant(
+    std::index_sequence<I...>);
+
+using variant = decltype(make_variant(std::make_index_sequence<ALTS>()));
+
+#if MODE == 0
+struct Matcher
+{
+    void operator()(const auto& t) const
+    {
+        std::cout << "auto! " << t->kind() << std::endl;
+    }
+
+    void operator()(const std::shared_ptr<node<0>>& t) const
+    {
+        std::cout << "node 0! " << t->kind() << std::endl;
+    }
+};
+#elif MODE == 1
+struct Matcher
+{
+    void operator()(const sBase& t) const
+    {
+        std::cout << "auto! " << t->kind() << std::endl;
+    }
+
+    void operator()(const std::shared_ptr<node<0>>& t) const
+    {
+        std::cout << "node 0! " << t->kind() << std::endl;
+    }
+};
+#endif
+
+void visit(const variant& v)
+{
+#if MODE == 2
+    static const auto matcher = misc::LambdaVisitor{
+        [](const sBase& t) {
+            std::cout << "auto! " << t->kind() << std::endl;
+        },
+        [](const std::shared_ptr<node<0>>& t) {
+            std::cout << "node 0! " << t->kind() << std::endl;
+        },
+    };
+    misc::visit(matcher, v);
+#else
+    std::visit(Matcher(), v);
+#endif
+}
@@ -0,0 +1,44 @@
+// Input of bench/compile-visit: visit ARGS variants of ALTS alternatives,
+// either with std::visit and a catch-all lambda, as in minmax.cc, or with
+// misc::visit_arms (USE_ARMS) and one specific arm plus one catch-all arm.
+
+#include <cstddef>
+#include <utility>
+#include <variant>
+
+#include "../../cpp-matching-hacks/lib/visit-arms.hh"
+
+#ifndef ARGS
+#    define ARGS 2
+#endif
+
+#ifndef ALTS
+#    define ALTS 2
+#endif
+
+template <std::size_t>
+struct alt
+{
+    int val;
+};
+
+template <std::size_t... I>
+std::variant<alt<I>...> make_variant(std::index_sequence<I...>);
+
+using variant = decltype(make_variant(std::make_index_sequence<ALTS>()));
+
+int visit(variant* vs)
+{
+    return [&]<std::size_t... I>(std::index_sequence<I...>) {
+        auto f = [](const auto&... xs) { return (0 + ... + int(sizeof xs)); };
+#ifdef USE_ARMS
+        auto arms = std::tuple{
+            misc::arm<std::conditional_t<I == 0, alt<0>, misc::any>...>(f),
+            misc::arm<std::conditional_t<I == 0, misc::any, misc::any>...>(f),
+        };
+        return misc::visit_arms(arms, vs[I]...);
+#else
+        return std::visit(f, vs[I]...);
+#endif
+    }(std::make_index_sequence<ARGS>());
+}
@@ -0,0 +1,115 @@
+// Lazy child variant benchmark: step6's Move nodes matched by a GasMatcher
+// like visitor, whose first arm only dispatches on the source, with both
+// child variants built up front and through misc::lazy_variant views.
+//
+// Half of the moves have an immediate source, for which the destination is
+// never inspected.
+//
+// Usage: ./bench/lazy [N] [ROUNDS]
+
+#include <cstdio>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "../cpp-matching-hacks/lib/lazy-variant.hh"
+#include "bench.hh"
+#include "tree-step6.hh"
+
+using namespace step6;
+
+enum Rule
+{
+    MOVE_IMM,
+    MOVE_MEM,
+    MOVE,
+    RULE_COUNT,
+};
+
+/// The rule of a Move whose source is \a s, looking at \a dst only if
+/// needed.
+template <typename S, typename Dst>
+static int rule(const S&, const Dst& dst)
+{
+    if constexpr (std::is_same_v<S, sInt>)
+        return MOVE_IMM;
+    else
+        return dst.visit([](const auto& d) {
+            if constexpr (requires { d->exp; })
+                return MOVE_MEM;
+            else
+                return MOVE;
+        });
+}
+
+/// The destination variant, built up front.
+template <typename V>
+struct eager
+{
+    template <typename F>
+    decltype(auto) visit(F&& f) const
+    {
+        return std::visit(f, v);
+    }
+
+    V v;
+};
+
+template <typename D, typename S>
+static int match_eager(Move<D, S>& m)
+{
+    eager<decltype(m.dst->variant())> dst{m.dst->variant()};
+    auto src = m.src->variant();
+    return std::visit([&](const auto& s) { return rule(s, dst); }, src);
+}
+
+template <typename D, typename S>
+static int match_lazy(Move<D, S>& m)
+{
+    auto dst = misc::lazy(m.dst);
+    auto src = misc::lazy(m.src);
+    return src.visit([&](const auto& s) { return rule(s, dst); });
+}
+
+int main(int argc, char* argv[])
+{
+    long n = bench::arg(argc, argv, 1, 100000);
+    long rounds = bench::arg(argc, argv, 2, 20);
+
+    std::vector<sMove<Mem<Int>, Int>> imms;
+    std::vector<sMove<Mem<Int>, Mem<Int>>> mems;
+    for (long i = 0; i < n / 2; ++i)
+    {
+        imms.push_back(make_move(make_mem(sInt(new Int(i))), sInt(new Int(i))));
+        mems.push_back(make_move(make_mem(sInt(new Int(i))),
+                                 make_mem(sInt(new Int(i)))));
+    }
+
+    auto run = [&](const char* name, auto match) {
+        long hits[RULE_COUNT] = {};
+        double ms = bench::time_ms([&] {
+            for (long r = 0; r < rounds; ++r)
+            {
+                for (const auto& m : imms)
+                    ++hits[match(*m)];
+                for (const auto& m : mems)
+                    ++hits[match(*m)];
+            }
+        });
+        std::printf("%-16s %10.2f ms %8.2f ns/move %10ld imm %10ld mem\n",
+                    name, ms, ms * 1e6 / (rounds * 2 * imms.size()),
+                    hits[MOVE_IMM], hits[MOVE_MEM]);
+        return hits[MOVE_IMM] + 2 * hits[MOVE_MEM] + 3 * hits[MOVE];
+    };
+
+    long eager_sum = run("eager variants",
+                         [](auto& m) { return match_eager(m); });
+    long lazy_sum = run("lazy variants", [](auto& m) { return match_lazy(m); });
+    if (eager_sum != lazy_sum)
+    {
+        std::printf("eager and lazy matching disagree\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Scaling benchmark of misc::parallel_match, from 1 to THREADS threads.
+//
+// The corpus is converted to std::shared_ptr nodes whose leaves are shared
+// between all the trees, as i1 and i2 are in step6: matching copies the
+// references, so every thread updates the same reference counts.  The
+// outputs of every run are checked against the sequential one.
+//
+// Usage: ./bench/parallel [NODES] [THREADS]
+
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../cpp-matching-hacks/lib/parallel-match.hh"
+#include "bench.hh"
+#include "generator.hh"
+
+struct Node;
+using sNode = std::shared_ptr<Node>;
+
+struct Node
+{
+    plain::Tree::Kind kind;
+    int val;
+    sNode children[2];
+};
+
+static sNode convert(const plain::Tree* t, std::vector<sNode>& leaves)
+{
+    if (t->kind_get() == plain::Tree::INT)
+    {
+        int val = static_cast<const plain::Int*>(t)->val;
+        if (!leaves[val])
+            leaves[val] = sNode(new Node{plain::Tree::INT, val, {}});
+        return leaves[val];
+    }
+
+    sNode res(new Node{t->kind_get(), 0, {}});
+    for (std::size_t i = 0; i < t->child_count(); ++i)
+        res->children[i] = convert(t->child_get(i), leaves);
+    return res;
+}
+
+/// Emit a rule for every node, bottom-up, copying the references.
+static int match(sNode n, std::vector<int>& out)
+{
+    int rule = n->kind * 16 + (n->kind == plain::Tree::INT ? n->val % 16 : 0);
+    for (int i = 0; i < 2; ++i)
+        if (sNode child = n->children[i])
+            rule += match(child, out) % 4;
+    out.push_back(rule);
+    return rule;
+}
+
+int main(int argc, char* argv[])
+{
+    bench::corpus_params params;
+    params.nodes = bench::arg(argc, argv, 1, 1000000);
+    unsigned max_threads = bench::arg(argc, argv, 2,
+                                      std::thread::hardware_concurrency());
+    bench::corpus corpus(params);
+
+    std::vector<sNode> leaves(64);
+    std::vector<sNode> roots;
+    for (auto root : corpus.roots_get())
+        roots.push_back(convert(root, leaves));
+
+    auto f = [](const sNode& root, std::vector<int>& out) {
+        match(root, out);
+    };
+
+    std::vector<int> reference;
+    double reference_ms = 0;
+    std::printf("%zu nodes, %zu trees\n", corpus.size(), roots.size());
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+        std::vector<int> res;
+        double ms = bench::time_ms([&] {
+            res = misc::parallel_match<int, sNode>(roots, f, threads);
+        });
+
+        if (threads == 1)
+        {
+            reference = std::move(res);
+            reference_ms = ms;
+        }
+        else if (res != reference)
+        {
+            std::printf("%u threads: outputs differ\n", threads);
+            return 1;
+        }
+
+        std::printf("%3u threads %10.2f ms %8.2f ns/node %6.2fx\n", threads,
+                    ms, ms * 1e6 / corpus.size(), reference_ms / ms);
+    }
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+/**
+ ** \file bench/perf.hh
+ ** \brief Hardware counters of the current thread, through perf_event_open.
+ **/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace bench
+{
+    /// Branch and cache misses of the current thread, in user space.
+    ///
+    /// perf_event_open is often unavailable, in containers and virtual
+    /// machines without a PMU or when perf_event_paranoid forbids it: the
+    /// counters are then not \c available() and read as -1.
+    class perf_counters
+    {
+    public:
+        enum counter
+        {
+            BRANCH_MISSES,
+            CACHE_MISSES,
+            COUNTER_COUNT,
+        };
+
+        perf_counters()
+        {
+            static constexpr std::uint64_t configs[COUNTER_COUNT] = {
+                PERF_COUNT_HW_BRANCH_MISSES,
+                PERF_COUNT_HW_CACHE_MISSES,
+            };
+            for (int c = 0; c < COUNTER_COUNT; ++c)
+            {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof attr);
+                attr.size = sizeof attr;
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = configs[c];
+                attr.disabled = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                fds_[c] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            }
+        }
+
+        perf_counters(const perf_counters&) = delete;
+        perf_counters& operator=(const perf_counters&) = delete;
+
+        ~perf_counters()
+        {
+            for (int fd : fds_)
+                if (fd >= 0)
+                    close(fd);
+        }
+
+        /// Whether every counter could be opened.
+        bool available() const
+        {
+            for (int fd : fds_)
+                if (fd < 0)
+                    return false;
+            return true;
+        }
+
+        /// Reset the counters and start counting.
+        void start()
+        {
+            for (int fd : fds_)
+                if (fd >= 0)
+                {
+                    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                }
+        }
+
+        /// Stop counting.
+        void stop()
+        {
+            for (int fd : fds_)
+                if (fd >= 0)
+                    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+
+        /// The value of counter \a c since the last start(), or -1.
+        long get(counter c) const
+        {
+            std::uint64_t value;
+            if (fds_[c] < 0
+                || read(fds_[c], &value, sizeof value) != sizeof value)
+                return -1;
+            return value;
+        }
+
+    private:
+        int fds_[COUNTER_COUNT];
+    };
+
+} // namespace bench
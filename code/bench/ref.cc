@@ -0,0 +1,132 @@
+// Copy-heavy matching benchmark: misc::ref over std::shared_ptr against the
+// intrusive reference counting policy, with atomic and non-atomic counts.
+//
+// Children are stored as variants of references, and the matcher takes them
+// by value as in the slides, so that every match copies references and
+// upcasts them through the converting constructor.  Only the copies are
+// timed, the trees are built beforehand.
+//
+// Usage: ./bench/ref [N] [ROUNDS]
+
+#include <cstdio>
+#include <variant>
+#include <vector>
+
+#include "../cpp-matching-hacks/lib/ref-fixed.hh"
+#include "bench.hh"
+
+/// Objects counted by std::shared_ptr do not hold any count.
+struct uncounted
+{
+    virtual ~uncounted() = default;
+};
+
+template <typename Policy, typename Base>
+struct nodes
+{
+    struct Tree : public Base
+    {};
+
+    struct Int;
+    struct Mem;
+    struct Move;
+
+    using sTree = misc::ref<Tree, Policy>;
+    using sInt = misc::ref<Int, Policy>;
+    using sMem = misc::ref<Mem, Policy>;
+    using sMove = misc::ref<Move, Policy>;
+
+    using vTree = std::variant<sMove, sMem, sInt>;
+
+    struct Int : public Tree
+    {
+        Int(int val)
+            : val(val)
+        {}
+
+        int val;
+    };
+
+    struct Mem : public Tree
+    {
+        Mem(vTree exp)
+            : exp(exp)
+        {}
+
+        vTree exp;
+    };
+
+    struct Move : public Tree
+    {
+        Move(vTree dst, vTree src)
+            : dst(dst)
+            , src(src)
+        {}
+
+        vTree dst;
+        vTree src;
+    };
+
+    struct Matcher
+    {
+        long operator()(sTree t)
+        {
+            return t.use_count();
+        }
+
+        long operator()(sMem m)
+        {
+            return 1 + std::visit(*this, vTree(m->exp));
+        }
+
+        long operator()(sMove m)
+        {
+            return std::visit(*this, vTree(m->dst))
+                + std::visit(*this, vTree(m->src));
+        }
+    };
+
+    /// Build the trees of step6's main function \a n times, and match them
+    /// \a rounds times.
+    static void run(const char* name, long n, long rounds)
+    {
+        std::vector<vTree> trees;
+        trees.reserve(2 * n);
+        for (long i = 0; i < n; ++i)
+        {
+            sInt i1(new Int(42));
+            sInt i2(new Int(21));
+            sMem mem1(new Mem(i1));
+            sMem mem2(new Mem(mem1));
+            trees.push_back(sMove(new Move(i2, mem2)));
+            trees.push_back(sMove(new Move(i2, i1)));
+        }
+
+        long sum = 0;
+        double ms = bench::time_ms([&] {
+            for (long r = 0; r < rounds; ++r)
+                for (const auto& t : trees)
+                    sum += std::visit(Matcher(), t);
+        });
+        bench::do_not_optimize(sum);
+
+        std::printf("%-22s %2zu B/ref %10.2f ms %8.2f ns/tree (%ld)\n", name,
+                    sizeof(sTree), ms, ms * 1e6 / (rounds * trees.size()),
+                    sum);
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    long n = bench::arg(argc, argv, 1, 100000);
+    long rounds = bench::arg(argc, argv, 2, 20);
+
+    std::printf("%ld trees, %ld rounds\n", 2 * n, rounds);
+    nodes<misc::shared_policy, uncounted>::run("shared_ptr", n, rounds);
+    nodes<misc::intrusive_policy<true>, misc::ref_counted<true>>::run(
+        "intrusive, atomic", n, rounds);
+    nodes<misc::intrusive_policy<false>, misc::ref_counted<false>>::run(
+        "intrusive, non-atomic", n, rounds);
+
+    return 0;
+}
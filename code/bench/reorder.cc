@@ -0,0 +1,156 @@
+// Profile-guided rule order benchmark: a misc::rule_chain matching every node
+// of a skewed synthetic corpus, its patterns tried in their order, then in
+// the order of a profile.
+//
+// - source order: the patterns as an instruction selector lists them, most
+//   specific first and Int last, though it is the hottest.  This run is the
+//   profiling one, it saves its misc::rule_profile to PROFILE.
+// - profile order: the chain built from the profile loaded back from PROFILE.
+// - pattern_matcher: the decision tree of the same patterns, for reference.
+//
+// The skew is set by the probability that an expression is a leaf, and that
+// a statement is a Move.  Times are reported per node, with the number of
+// patterns tried per node, each failed one being a branch the predictor may
+// miss, and the branch misses themselves when perf_event_open is available.
+//
+// Usage: ./bench/reorder [NODES] [LEAF%] [MOVE%] [PROFILE]
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../cpp-matching-hacks/lib/pattern-matcher.hh"
+#include "../cpp-matching-hacks/lib/rule-chain.hh"
+#include "bench.hh"
+#include "generator.hh"
+#include "perf.hh"
+
+using plain::Tree;
+
+static misc::pattern pInt()
+{
+    return {Tree::INT};
+}
+
+static misc::pattern pMem(misc::pattern exp)
+{
+    return {Tree::MEM, {exp}};
+}
+
+static misc::pattern pMove(misc::pattern dst, misc::pattern src)
+{
+    return {Tree::MOVE, {dst, src}};
+}
+
+/// Every node under \a t, shared ones as often as they are reached.
+static void collect(Tree* t, std::vector<const Tree*>& nodes)
+{
+    for (std::size_t i = 0; i < t->child_count(); ++i)
+        collect(t->child_get(i), nodes);
+    nodes.push_back(t);
+}
+
+/// Run \a m on \a nodes, and report its cost per node.
+template <typename Matcher>
+static misc::rule_profile run(const char* name, const Matcher& m,
+                              const std::vector<const Tree*>& nodes,
+                              std::size_t rules)
+{
+    misc::rule_profile res(rules);
+    bench::perf_counters perf;
+    perf.start();
+    double ms = bench::time_ms([&] {
+        for (auto n : nodes)
+            res.hit(m.match(*n));
+    });
+    perf.stop();
+
+    std::printf("%-16s %10.2f ms %8.2f ns/node", name, ms,
+                ms * 1e6 / nodes.size());
+    if (perf.available())
+        std::printf(" %8.3f br-miss/node",
+                    double(perf.get(bench::perf_counters::BRANCH_MISSES))
+                        / nodes.size());
+    else
+        std::printf(" (no perf counters)");
+    std::printf("\n");
+    return res;
+}
+
+/// The number of patterns \a chain tries per node, given their \a hits.
+static double tried(const misc::rule_chain<Tree>& chain,
+                    const misc::rule_profile& hits)
+{
+    double res = 0;
+    double nodes = 0;
+    const auto& order = chain.order_get();
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+        res += double(hits.hits_get(order[i])) * (i + 1);
+        nodes += hits.hits_get(order[i]);
+    }
+    return res / nodes;
+}
+
+int main(int argc, char* argv[])
+{
+    bench::corpus_params params;
+    params.nodes = bench::arg(argc, argv, 1, 1000000);
+    params.leaf_probability = bench::arg(argc, argv, 2, 70) / 100.;
+    params.move_ratio = bench::arg(argc, argv, 3, 80) / 100.;
+    std::string path = argc > 4 ? argv[4] : "/tmp/reorder.profile";
+    bench::corpus corpus(params);
+
+    std::vector<const Tree*> nodes;
+    for (auto t : corpus.roots_get())
+        collect(t, nodes);
+
+    using misc::_;
+    const std::vector<misc::pattern> patterns = {
+        pMove(pMem(pMem(_)), _), // 0
+        pMove(pMem(_), pInt()),  // 1
+        pMove(_, pMem(_)),       // 2
+        pMove(pInt(), pInt()),   // 3
+        pMove(_, _),             // 4
+        pMem(pMem(_)),           // 5
+        pMem(pMove(_, _)),       // 6
+        pMem(_),                 // 7
+        pInt(),                  // 8
+    };
+
+    std::printf("%zu nodes, %zu statements\n", nodes.size(),
+                corpus.roots_get().size());
+
+    // Profiling run, saved to a file
+    misc::rule_chain<Tree> source(patterns);
+    auto profile = run("source order", source, nodes, patterns.size());
+    {
+        std::ofstream o(path);
+        profile.save(o);
+    }
+
+    // Later run, from the file
+    std::ifstream i(path);
+    misc::rule_chain<Tree> hot(patterns, misc::rule_profile::load(i));
+    auto hot_hits = run("profile order", hot, nodes, patterns.size());
+
+    misc::pattern_matcher<Tree> tree(patterns);
+    auto tree_hits = run("pattern_matcher", tree, nodes, patterns.size());
+
+    std::printf("order:");
+    for (int r : hot.order_get())
+        std::printf(" %d", r);
+    std::printf("\npatterns tried per node: %.3f in source order, %.3f in "
+                "profile order\n",
+                tried(source, profile), tried(hot, profile));
+
+    for (std::size_t r = 0; r < patterns.size(); ++r)
+        if (hot_hits.hits_get(r) != profile.hits_get(r)
+            || tree_hits.hits_get(r) != profile.hits_get(r))
+        {
+            std::printf("matchers disagree\n");
+            return 1;
+        }
+    return 0;
+}
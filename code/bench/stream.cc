@@ -0,0 +1,203 @@
+// Streaming deserialization benchmark: reading a synthetic corpus written by
+// misc::tree_writer to a file, then matching every node.
+//
+// - temporaries: parsed into heap allocated temporary objects, then copied
+//   into arena nodes, as a parser feeding make_mem and make_move would.
+// - arena: built by a misc::tree_reader straight into arena nodes.
+// - flat: built by a misc::tree_reader into a misc::flat_tree.
+// - match as you go: each statement is built in the arena, matched, and
+//   the arena reset, so the forest is never resident.
+//
+// Each run is isolated in its own process, which reports its peak RSS.
+//
+// Usage: ./bench/stream [NODES] [FILE]
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../cpp-matching-hacks/lib/arena.hh"
+#include "../cpp-matching-hacks/lib/flat-tree.hh"
+#include "../cpp-matching-hacks/lib/tree-automaton.hh"
+#include "../cpp-matching-hacks/lib/tree-stream.hh"
+#include "bench.hh"
+#include "generator.hh"
+
+using namespace plain;
+using misc::op;
+using misc::wild;
+
+using Automaton = misc::tree_automaton<
+    Tree::kind_count,
+    op<Tree::MEM, op<Tree::MEM, wild>>,
+    op<Tree::MEM, wild>,
+    op<Tree::MOVE, op<Tree::INT>, op<Tree::INT>>,
+    op<Tree::MOVE, op<Tree::MEM, wild>, op<Tree::MEM, wild>>,
+    op<Tree::MOVE, wild, wild>,
+    wild>;
+
+static void write(misc::tree_writer& writer, const Tree* t)
+{
+    if (t->kind_get() == Tree::INT)
+        return writer.leaf(Tree::INT, static_cast<const Int*>(t)->val);
+    writer.node(t->kind_get(), t->child_count());
+    for (std::size_t i = 0; i < t->child_count(); ++i)
+        write(writer, t->child_get(i));
+}
+
+/// Sum of the rules of every node under \a root.
+static long match(const Tree& root)
+{
+    long res = 0;
+    Automaton::match_all(root, [&](const Tree&, int rule) { res += rule; });
+    return res;
+}
+
+/// Build the nodes read by a misc::tree_reader in an arena.
+struct ArenaBuilder
+{
+    Tree* leaf(misc::tree_writer::kind_type, int val)
+    {
+        return arena.make<Int>(val);
+    }
+
+    Tree* node(misc::tree_writer::kind_type kind, Tree* const* children,
+               std::size_t)
+    {
+        if (kind == Tree::MEM)
+            return arena.make<Mem>(children[0]);
+        return arena.make<Move>(children[0], children[1]);
+    }
+
+    misc::arena& arena;
+};
+
+/// A parsed node, before it is turned into a Tree.
+struct Temporary
+{
+    Tree::Kind kind;
+    int val = 0;
+    std::vector<std::unique_ptr<Temporary>> children;
+};
+
+static std::unique_ptr<Temporary> parse(std::istream& in)
+{
+    int tag = in.get();
+    if (tag == EOF)
+        return nullptr;
+    auto res = std::make_unique<Temporary>();
+    res->kind = Tree::Kind(tag >> 2);
+    if (std::size_t arity = tag & 3)
+        for (std::size_t i = 0; i < arity; ++i)
+            res->children.push_back(parse(in));
+    else
+    {
+        std::uint32_t u = 0;
+        for (int shift = 0, c = 0x80; c & 0x80; shift += 7)
+        {
+            c = in.get();
+            u |= std::uint32_t(c & 0x7f) << shift;
+        }
+        res->val = static_cast<int>((u >> 1) ^ (~(u & 1) + 1));
+    }
+    return res;
+}
+
+static Tree* build(misc::arena& arena, const Temporary& t)
+{
+    switch (t.kind)
+    {
+    case Tree::INT:
+        return arena.make<Int>(t.val);
+    case Tree::MEM:
+        return arena.make<Mem>(build(arena, *t.children[0]));
+    default:
+        return arena.make<Move>(build(arena, *t.children[0]),
+                                build(arena, *t.children[1]));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string file = argc > 2 ? argv[2] : "/tmp/bench-stream.bin";
+    long expected = 0;
+    {
+        bench::corpus_params params;
+        params.nodes = bench::arg(argc, argv, 1, 1000000);
+        bench::corpus corpus(params);
+        std::ofstream out(file, std::ios::binary);
+        misc::tree_writer writer(out);
+        for (auto t : corpus.roots_get())
+        {
+            write(writer, t);
+            expected += match(*t);
+        }
+        std::printf("%zu nodes, %ld bytes\n", corpus.size(),
+                    long(out.tellp()));
+    }
+
+    // A run whose rules differ aborts, and isolated() reports a negative
+    // time.
+    auto check = [&](long sum) {
+        if (sum != expected)
+            std::abort();
+    };
+
+    bench::isolated("temporaries", [&] {
+        std::ifstream in(file, std::ios::binary);
+        misc::arena arena;
+        std::vector<Tree*> roots;
+        while (auto t = parse(in))
+            roots.push_back(build(arena, *t));
+        long sum = 0;
+        for (auto root : roots)
+            sum += match(*root);
+        check(sum);
+    });
+
+    bench::isolated("arena", [&] {
+        std::ifstream in(file, std::ios::binary);
+        misc::arena arena;
+        misc::tree_reader<Tree*> reader(in);
+        std::vector<Tree*> roots;
+        reader.for_each(ArenaBuilder{arena},
+                        [&](Tree* root) { roots.push_back(root); });
+        long sum = 0;
+        for (auto root : roots)
+            sum += match(*root);
+        check(sum);
+    });
+
+    bench::isolated("flat", [&] {
+        std::ifstream in(file, std::ios::binary);
+        misc::flat_tree tree;
+        misc::flat_builder builder(tree);
+        misc::tree_reader<misc::flat_tree::index_type> reader(in);
+        reader.for_each(builder, [](misc::flat_tree::index_type) {});
+        long sum = 0;
+        std::vector<Automaton::state_type> states;
+        Automaton::match_flat(tree, states,
+                              [&](auto, int rule) { sum += rule; });
+        check(sum);
+    });
+
+    bench::isolated("match as you go", [&] {
+        std::ifstream in(file, std::ios::binary);
+        misc::arena arena;
+        misc::tree_reader<Tree*> reader(in);
+        long sum = 0;
+        reader.for_each(ArenaBuilder{arena}, [&](Tree* root) {
+            sum += match(*root);
+            arena.reset();
+        });
+        check(sum);
+    });
+
+    std::remove(file.c_str());
+    return 0;
+}
@@ -0,0 +1,70 @@
+// Dispatch benchmark: std::visit over the variant() virtual method of
+// match-tree-step6.cc against misc::tag_visit of match-tree-tag-dispatch.cc.
+//
+// Usage: ./bench/tag-dispatch [N]
+
+#include <cstdio>
+
+#include "bench.hh"
+#include "tree-step6.hh"
+
+using namespace step6;
+
+int main(int argc, char* argv[])
+{
+    long n = bench::arg(argc, argv, 1, 10000000);
+
+    sInt i1(new Int(42));
+    sInt i2(new Int(21));
+
+    auto mem1 = make_mem(i1);
+    auto mem2 = make_mem(mem1);
+    auto move1 = make_move(i2, mem2);
+    auto move2 = make_move(i2, i1);
+
+    // Matched through the base class, as a real selector would
+    sTree<Int, None> tree = mem1;
+
+    CountingMatcher visit_matcher;
+    double visit_ms = bench::time_ms([&] {
+        for (long i = 0; i < n; ++i)
+        {
+            std::visit(visit_matcher, mem1->variant());
+            std::visit(visit_matcher, mem2->variant());
+            std::visit(visit_matcher, move1->variant());
+            std::visit(visit_matcher, move2->variant());
+            std::visit(visit_matcher, i1->variant());
+            std::visit(visit_matcher, tree->variant());
+        }
+    });
+
+    CountingMatcher tag_matcher;
+    double tag_ms = bench::time_ms([&] {
+        for (long i = 0; i < n; ++i)
+        {
+            misc::tag_visit(tag_matcher, *mem1);
+            misc::tag_visit(tag_matcher, *mem2);
+            misc::tag_visit(tag_matcher, *move1);
+            misc::tag_visit(tag_matcher, *move2);
+            misc::tag_visit(tag_matcher, *i1);
+            misc::tag_visit(tag_matcher, *tree);
+        }
+    });
+
+    for (int r = 0; r < CountingMatcher::RULE_COUNT; ++r)
+        if (visit_matcher.hits[r] != tag_matcher.hits[r])
+        {
+            std::printf("rule %d: %ld hits with std::visit, %ld with tags\n",
+                        r, visit_matcher.hits[r], tag_matcher.hits[r]);
+            return 1;
+        }
+
+    long matches = visit_matcher.total();
+    std::printf("%ld matches\n", matches);
+    std::printf("%-24s %10.2f ms %8.2f ns/match\n", "std::visit", visit_ms,
+                visit_ms * 1e6 / matches);
+    std::printf("%-24s %10.2f ms %8.2f ns/match\n", "misc::tag_visit", tag_ms,
+                tag_ms * 1e6 / matches);
+
+    return 0;
+}
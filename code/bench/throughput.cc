@@ -0,0 +1,451 @@
+// Matching throughput harness: the matcher styles of the slides over the same
+// synthetic corpus, every node of every statement being matched.
+//
+// - std::visit: the non-templated tree of match-tree.cc, with raw pointers.
+// - step6: the templated variants of match-tree-step6.cc.  Statements are
+//   type-erased behind a thunk, since their types depend on their shapes,
+//   and only corpora without nested Move and at most 8 levels deep fit.
+// - misc::ref upcast: match-tree-upcast-ref.cc, the catch-all overload
+//   taking an upcast misc::ref.
+//
+// The shared subtrees of the corpus are shared in every style.  Times are
+// reported per matched node, as are branch and cache misses when
+// perf_event_open is available.
+//
+// Usage: ./bench/throughput [NODES] [MAX_DEPTH] [FANOUT%] [SHARING%] [UNIFORM]
+
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "../cpp-matching-hacks/lib/ref-fixed.hh"
+#include "bench.hh"
+#include "generator.hh"
+#include "perf.hh"
+#include "tree-step6.hh"
+
+/// The rules of every matcher.
+enum Rule
+{
+    INT,
+    MEM_MEM,
+    MEM,
+    MOVE,
+    RULE_COUNT,
+};
+
+using hits_type = std::array<long, RULE_COUNT>;
+
+/*-------------.
+| std::visit.  |
+`-------------*/
+
+namespace visit
+{
+    using namespace plain;
+
+    struct Matcher
+    {
+        int operator()(Int*)
+        {
+            return INT;
+        }
+
+        int operator()(Mem* m)
+        {
+            return std::visit(
+                [](auto* exp) {
+                    return std::is_same_v<decltype(exp), Mem*> ? MEM_MEM
+                                                               : MEM;
+                },
+                m->exp->variant());
+        }
+
+        int operator()(Move*)
+        {
+            return MOVE;
+        }
+    };
+
+    static void match_all(Tree* t, hits_type& hits)
+    {
+        for (std::size_t i = 0; i < t->child_count(); ++i)
+            match_all(t->child_get(i), hits);
+        ++hits[std::visit(Matcher(), t->variant())];
+    }
+} // namespace visit
+
+/*--------.
+| step6.  |
+`--------*/
+
+namespace templated
+{
+    using namespace step6;
+
+    struct Matcher
+    {
+        hits_type& hits;
+
+        void operator()(const sInt&)
+        {
+            ++hits[INT];
+        }
+
+        template <typename T>
+        void operator()(const sMem<Mem<T>>&)
+        {
+            ++hits[MEM_MEM];
+        }
+
+        template <typename T>
+        void operator()(const sMem<T>&)
+        {
+            ++hits[MEM];
+        }
+
+        template <typename D, typename S>
+        void operator()(const sMove<D, S>&)
+        {
+            ++hits[MOVE];
+        }
+    };
+
+    template <typename T>
+    void match_all(T& t, Matcher& m)
+    {
+        if constexpr (requires { t.exp; })
+            match_all(*t.exp, m);
+        else if constexpr (requires { t.dst; })
+        {
+            match_all(*t.dst, m);
+            match_all(*t.src, m);
+        }
+        std::visit(m, t.variant());
+    }
+
+    /// Mem<...<Mem<Int>>...>, with \a K Mem.
+    template <int K>
+    struct mem_n
+    {
+        using type = Mem<typename mem_n<K - 1>::type>;
+    };
+
+    template <>
+    struct mem_n<0>
+    {
+        using type = Int;
+    };
+
+    template <int K>
+    using mem_n_t = typename mem_n<K>::type;
+
+    /// Mem chains are shorter than max_mems, enough for corpora 8 levels
+    /// deep.
+    constexpr int max_mems = 8;
+
+    /// A statement, of any type.
+    struct root
+    {
+        std::shared_ptr<void> node;
+        void (*match)(void*, Matcher&);
+    };
+
+    template <typename T>
+    void match_thunk(void* t, Matcher& m)
+    {
+        match_all(*static_cast<T*>(t), m);
+    }
+
+    using memo_type =
+        std::unordered_map<const plain::Tree*, std::shared_ptr<void>>;
+
+    template <int K>
+    std::shared_ptr<mem_n_t<K>> build(const plain::Tree* t, memo_type& memo)
+    {
+        if (auto it = memo.find(t); it != memo.end())
+            return std::static_pointer_cast<mem_n_t<K>>(it->second);
+
+        std::shared_ptr<mem_n_t<K>> res;
+        if constexpr (K == 0)
+            res = sInt(new Int(static_cast<const plain::Int*>(t)->val));
+        else
+            res = make_mem(build<K - 1>(t->child_get(0), memo));
+        memo[t] = res;
+        return res;
+    }
+
+    template <int K>
+    root build_exp(const plain::Tree* t, memo_type& memo)
+    {
+        return {build<K>(t, memo), &match_thunk<mem_n_t<K>>};
+    }
+
+    template <int I>
+    root build_move(const plain::Tree* t, memo_type& memo)
+    {
+        constexpr int D = I / max_mems;
+        constexpr int S = I % max_mems;
+        auto res = make_move(build<D>(t->child_get(0), memo),
+                             build<S>(t->child_get(1), memo));
+        return {res, &match_thunk<Move<mem_n_t<D>, mem_n_t<S>>>};
+    }
+
+    using builder = root (*)(const plain::Tree*, memo_type&);
+
+    template <int... Ks>
+    constexpr std::array<builder, sizeof...(Ks)>
+    exp_builders(std::integer_sequence<int, Ks...>)
+    {
+        return {&build_exp<Ks>...};
+    }
+
+    template <int... Is>
+    constexpr std::array<builder, sizeof...(Is)>
+    move_builders(std::integer_sequence<int, Is...>)
+    {
+        return {&build_move<Is>...};
+    }
+
+    /// The number of Mem above the leaf of \a t, or -1 if it has a Move.
+    static int mems(const plain::Tree* t)
+    {
+        int res = 0;
+        for (; t->kind_get() == plain::Tree::MEM; t = t->child_get(0))
+            ++res;
+        return t->kind_get() == plain::Tree::INT ? res : -1;
+    }
+
+    /// Convert \a roots, or return false if they do not fit.
+    static bool build_all(const std::vector<plain::Tree*>& roots,
+                          std::vector<root>& res)
+    {
+        static constexpr auto exps =
+            exp_builders(std::make_integer_sequence<int, max_mems>());
+        static constexpr auto moves = move_builders(
+            std::make_integer_sequence<int, max_mems * max_mems>());
+
+        memo_type memo;
+        for (auto t : roots)
+        {
+            if (t->kind_get() != plain::Tree::MOVE)
+            {
+                int k = mems(t);
+                if (k < 0 || k >= max_mems)
+                    return false;
+                res.push_back(exps[k](t, memo));
+                continue;
+            }
+            int d = mems(t->child_get(0));
+            int s = mems(t->child_get(1));
+            if (d < 0 || s < 0 || d >= max_mems || s >= max_mems)
+                return false;
+            res.push_back(moves[d * max_mems + s](t, memo));
+        }
+        return true;
+    }
+} // namespace templated
+
+/*--------------------.
+| misc::ref upcasts.  |
+`--------------------*/
+
+namespace upcast
+{
+    struct Tree
+    {
+        virtual ~Tree() = default;
+    };
+
+    struct Int;
+    struct Mem;
+    struct Move;
+
+    using sTree = misc::ref<Tree>;
+    using sInt = misc::ref<Int>;
+    using sMem = misc::ref<Mem>;
+    using sMove = misc::ref<Move>;
+
+    using vTree = std::variant<sMem, sMove, sInt>;
+
+    struct Int : public Tree
+    {
+        Int(int val)
+            : val(val)
+        {}
+
+        int val;
+    };
+
+    struct Mem : public Tree
+    {
+        Mem(vTree exp)
+            : exp(exp)
+        {}
+
+        vTree exp;
+    };
+
+    struct Move : public Tree
+    {
+        Move(vTree dst, vTree src)
+            : dst(dst)
+            , src(src)
+        {}
+
+        vTree dst;
+        vTree src;
+    };
+
+    struct Matcher
+    {
+        int operator()(sTree)
+        {
+            return INT;
+        }
+
+        int operator()(sMem m)
+        {
+            return std::holds_alternative<sMem>(m->exp) ? MEM_MEM : MEM;
+        }
+
+        int operator()(sMove)
+        {
+            return MOVE;
+        }
+    };
+
+    static void match_all(const vTree& t, hits_type& hits)
+    {
+        if (auto m = std::get_if<sMem>(&t))
+            match_all((*m)->exp, hits);
+        else if (auto m = std::get_if<sMove>(&t))
+        {
+            match_all((*m)->dst, hits);
+            match_all((*m)->src, hits);
+        }
+        ++hits[std::visit(Matcher(), t)];
+    }
+
+    using memo_type = std::unordered_map<const plain::Tree*, vTree>;
+
+    static vTree build(const plain::Tree* t, memo_type& memo)
+    {
+        if (auto it = memo.find(t); it != memo.end())
+            return it->second;
+
+        vTree res;
+        switch (t->kind_get())
+        {
+        case plain::Tree::INT:
+            res = sInt(new Int(static_cast<const plain::Int*>(t)->val));
+            break;
+        case plain::Tree::MEM:
+            res = sMem(new Mem(build(t->child_get(0), memo)));
+            break;
+        case plain::Tree::MOVE:
+            {
+                auto dst = build(t->child_get(0), memo);
+                auto src = build(t->child_get(1), memo);
+                res = sMove(new Move(dst, src));
+            }
+            break;
+        }
+        memo[t] = res;
+        return res;
+    }
+} // namespace upcast
+
+/*----------.
+| Harness.  |
+`----------*/
+
+/// Run \a f, which fills \a hits, and report its cost per matched node.
+template <typename F>
+static hits_type run(const char* name, F f)
+{
+    hits_type hits = {};
+    bench::perf_counters perf;
+    perf.start();
+    double ms = bench::time_ms([&] { f(hits); });
+    perf.stop();
+
+    long nodes = 0;
+    for (auto h : hits)
+        nodes += h;
+
+    std::printf("%-20s %10.2f ms %8.2f ns/node", name, ms, ms * 1e6 / nodes);
+    if (perf.available())
+        std::printf(" %8.3f br-miss/node %8.3f cache-miss/node",
+                    double(perf.get(bench::perf_counters::BRANCH_MISSES))
+                        / nodes,
+                    double(perf.get(bench::perf_counters::CACHE_MISSES))
+                        / nodes);
+    else
+        std::printf(" (no perf counters)");
+    std::printf("\n");
+    return hits;
+}
+
+int main(int argc, char* argv[])
+{
+    bench::corpus_params params;
+    params.nodes = bench::arg(argc, argv, 1, 1000000);
+    params.max_depth = bench::arg(argc, argv, 2, 6);
+    params.fanout = bench::arg(argc, argv, 3, 0) / 100.;
+    params.sharing = bench::arg(argc, argv, 4, 0) / 100.;
+    if (bench::arg(argc, argv, 5, 0))
+        params.depth = bench::corpus_params::distribution::uniform;
+    bench::corpus corpus(params);
+    const auto& roots = corpus.roots_get();
+
+    std::vector<templated::root> step6_roots;
+    bool step6 = templated::build_all(roots, step6_roots);
+
+    upcast::memo_type memo;
+    std::vector<upcast::vTree> upcast_roots;
+    for (auto t : roots)
+        upcast_roots.push_back(upcast::build(t, memo));
+    memo.clear();
+
+    std::printf("%zu distinct nodes, %zu statements\n", corpus.size(),
+                roots.size());
+
+    auto visit_hits = run("std::visit", [&](hits_type& hits) {
+        for (auto t : roots)
+            visit::match_all(t, hits);
+    });
+
+    if (step6)
+    {
+        auto step6_hits = run("step6", [&](hits_type& hits) {
+            templated::Matcher m{hits};
+            for (const auto& r : step6_roots)
+                r.match(r.node.get(), m);
+        });
+        if (step6_hits != visit_hits)
+        {
+            std::printf("step6 and std::visit disagree\n");
+            return 1;
+        }
+    }
+    else
+        std::printf("%-20s does not fit the corpus\n", "step6");
+
+    auto upcast_hits = run("misc::ref upcast", [&](hits_type& hits) {
+        for (const auto& t : upcast_roots)
+            upcast::match_all(t, hits);
+    });
+    if (upcast_hits != visit_hits)
+    {
+        std::printf("misc::ref upcast and std::visit disagree\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+/**
+ ** \file bench/tree-plain.hh
+ ** \brief The non-templated tree of match-tree.cc, shared by the benchmarks.
+ **
+ ** Nodes carry the kind tag of match-tree-patterns.cc, so that they can be
+ ** matched by the libraries of cpp-matching-hacks/lib, and a variant()
+ ** virtual method for std::visit.  They are allocated in a misc::arena.
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <variant>
+
+namespace plain
+{
+    struct Int;
+    struct Mem;
+    struct Move;
+
+    using vTree = std::variant<Mem*, Move*, Int*>;
+
+    /// Tree is the abstract class all nodes inherit from.
+    struct Tree
+    {
+        enum Kind
+        {
+            INT,
+            MEM,
+            MOVE,
+        };
+
+        static constexpr std::size_t kind_count = 3;
+
+        Tree(Kind kind)
+            : kind(kind)
+        {}
+
+        virtual void traverse() const = 0;
+
+        virtual vTree variant() = 0;
+
+        Kind kind_get() const
+        {
+            return kind;
+        }
+
+        /// The number of children of the node.
+        std::size_t child_count() const
+        {
+            return kind == INT ? 0 : kind == MEM ? 1 : 2;
+        }
+
+        /// The \a i th child of the node, dispatched on the kind tag.
+        Tree* child_get(std::size_t i) const;
+
+        const Kind kind;
+    };
+
+    /// Int is a leaf, it represents an immediate value.
+    struct Int : public Tree
+    {
+        Int(int val)
+            : Tree(INT)
+            , val(val)
+        {}
+
+        virtual void traverse() const override
+        {
+            std::cout << val;
+        }
+
+        virtual vTree variant() override
+        {
+            return this;
+        }
+
+        int val;
+    };
+
+    /// Mem is a node with one child, it represents a memory access.
+    struct Mem : public Tree
+    {
+        Mem(Tree* exp)
+            : Tree(MEM)
+            , exp(exp)
+        {}
+
+        virtual void traverse() const override
+        {
+            std::cout << "Mem(";
+            exp->traverse();
+            std::cout << ")";
+        }
+
+        virtual vTree variant() override
+        {
+            return this;
+        }
+
+        Tree* exp;
+    };
+
+    /// Move is a node with two children, it represents an assembly move.
+    struct Move : public Tree
+    {
+        Move(Tree* dst, Tree* src)
+            : Tree(MOVE)
+            , dst(dst)
+            , src(src)
+        {}
+
+        virtual void traverse() const override
+        {
+            std::cout << "Move(";
+            dst->traverse();
+            std::cout << ",";
+            src->traverse();
+            std::cout << ")";
+        }
+
+        virtual vTree variant() override
+        {
+            return this;
+        }
+
+        Tree* dst;
+        Tree* src;
+    };
+
+    inline Tree* Tree::child_get(std::size_t i) const
+    {
+        switch (kind)
+        {
+        case MEM:
+            return static_cast<const Mem*>(this)->exp;
+        case MOVE:
+            return i == 0 ? static_cast<const Move*>(this)->dst
+                          : static_cast<const Move*>(this)->src;
+        default:
+            return nullptr;
+        }
+    }
+
+} // namespace plain
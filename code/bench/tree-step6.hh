@@ -0,0 +1,298 @@
+/**
+ ** \file bench/tree-step6.hh
+ ** \brief The tree of match-tree-step6.cc, shared by the benchmarks.
+ **
+ ** Nodes are the same as in match-tree-tag-dispatch.cc: they can be matched
+ ** through both the variant() virtual method and their kind tag.
+ **/
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <variant>
+
+#include "../cpp-matching-hacks/lib/tag-visit.hh"
+
+namespace step6
+{
+    // Forward declarations
+    template <typename T1, typename T2>
+    struct Tree;
+
+    struct Int;
+
+    template <typename T>
+    struct Mem;
+
+    template <typename D, typename S>
+    struct Move;
+
+    // Smart pointers declarations
+    template <typename T1, typename T2>
+    using sTree = std::shared_ptr<Tree<T1, T2>>;
+
+    using sInt = std::shared_ptr<Int>;
+
+    template <typename T>
+    using sMem = std::shared_ptr<Mem<T>>;
+
+    template <typename D, typename S>
+    using sMove = std::shared_ptr<Move<D, S>>;
+
+    // Variant declarations
+    template <typename T1, typename T2>
+    using vTree = std::variant<sMem<T1>, sMove<T1, T2>, sInt>;
+
+    // Borrowed variant, see match-tree-borrowed.cc
+    template <typename T1, typename T2>
+    using rTree = std::variant<Mem<T1>*, Move<T1, T2>*, Int*>;
+
+    // Kind tags, in the same order as the variant alternatives
+    enum class Kind : std::uint8_t
+    {
+        MEM,
+        MOVE,
+        INT,
+    };
+
+    template <typename T1, typename T2>
+    struct Tree
+    {
+        using alternatives_type =
+            misc::alternatives<Mem<T1>, Move<T1, T2>, Int>;
+
+        Tree(Kind kind)
+            : kind(kind)
+        {}
+
+        Kind kind_get() const
+        {
+            return kind;
+        }
+
+        virtual void traverse() = 0;
+
+        virtual vTree<T1, T2> variant() = 0;
+
+        virtual rTree<T1, T2> variant_ref() = 0;
+
+        const Kind kind;
+    };
+
+    // Dummy class
+    struct None : public Tree<None, None>
+    {
+        virtual void traverse() override
+        {
+            assert(0);
+        }
+
+        virtual vTree<None, None> variant() override
+        {
+            assert(0);
+            return {};
+        }
+
+        virtual rTree<None, None> variant_ref() override
+        {
+            assert(0);
+            return {};
+        }
+    };
+
+    struct Int
+        : public Tree<None, None>
+        , std::enable_shared_from_this<Int>
+    {
+        Int(int val)
+            : Tree(Kind::INT)
+            , val(val)
+        {}
+
+        virtual void traverse() override
+        {
+            std::cout << val;
+        }
+
+        virtual vTree<None, None> variant() override
+        {
+            sInt res(this->shared_from_this());
+            return res;
+        }
+
+        virtual rTree<None, None> variant_ref() override
+        {
+            return this;
+        }
+
+        int val;
+    };
+
+    template <typename T>
+    struct Mem
+        : public Tree<T, None>
+        , std::enable_shared_from_this<Mem<T>>
+    {
+        using exp_t = std::shared_ptr<T>;
+
+        Mem(exp_t exp)
+            : Tree<T, None>(Kind::MEM)
+            , exp(exp)
+        {}
+
+        virtual void traverse() override
+        {
+            std::cout << "Mem(";
+            exp->traverse();
+            std::cout << ")";
+        }
+
+        virtual vTree<T, None> variant() override
+        {
+            sMem<T> res(this->shared_from_this());
+            return res;
+        }
+
+        virtual rTree<T, None> variant_ref() override
+        {
+            return this;
+        }
+
+        exp_t exp;
+    };
+
+    template <typename D, typename S>
+    struct Move
+        : public Tree<D, S>
+        , std::enable_shared_from_this<Move<D, S>>
+    {
+        using dst_t = std::shared_ptr<D>;
+        using src_t = std::shared_ptr<S>;
+
+        Move(dst_t dst, src_t src)
+            : Tree<D, S>(Kind::MOVE)
+            , dst(dst)
+            , src(src)
+        {}
+
+        virtual void traverse() override
+        {
+            std::cout << "Move(";
+            dst->traverse();
+            std::cout << ",";
+            src->traverse();
+            std::cout << ")";
+        }
+
+        virtual vTree<D, S> variant() override
+        {
+            sMove<D, S> res(this->shared_from_this());
+            return res;
+        }
+
+        virtual rTree<D, S> variant_ref() override
+        {
+            return this;
+        }
+
+        dst_t dst;
+        src_t src;
+    };
+
+    template <typename T>
+    sMem<T> make_mem(const std::shared_ptr<T>& exp)
+    {
+        return sMem<T>(new Mem(exp));
+    }
+
+    template <typename D, typename S>
+    sMove<D, S> make_move(const std::shared_ptr<D>& dst,
+                          const std::shared_ptr<S>& src)
+    {
+        return sMove<D, S>(new Move(dst, src));
+    }
+
+    /// The rules of step6's Matcher, counting hits instead of printing.
+    ///
+    /// Each overload exists for both the smart pointer, as used by
+    /// std::visit, and the node reference, as used by misc::tag_visit.
+    struct CountingMatcher
+    {
+        enum Rule
+        {
+            AUTO,
+            MEM_MEM,
+            MEM,
+            MOVE_SAME,
+            MOVE_DIFF,
+            RULE_COUNT,
+        };
+
+        long hits[RULE_COUNT] = {};
+
+        void operator()(const auto&)
+        {
+            ++hits[AUTO];
+        }
+
+        template <typename T>
+        void operator()(const sMem<Mem<T>>&)
+        {
+            ++hits[MEM_MEM];
+        }
+
+        template <typename T>
+        void operator()(Mem<Mem<T>>&)
+        {
+            ++hits[MEM_MEM];
+        }
+
+        template <typename T>
+        void operator()(const sMem<T>&)
+        {
+            ++hits[MEM];
+        }
+
+        template <typename T>
+        void operator()(Mem<T>&)
+        {
+            ++hits[MEM];
+        }
+
+        template <typename T>
+        void operator()(const sMove<T, T>&)
+        {
+            ++hits[MOVE_SAME];
+        }
+
+        template <typename T>
+        void operator()(Move<T, T>&)
+        {
+            ++hits[MOVE_SAME];
+        }
+
+        template <typename T1, typename T2>
+        void operator()(const sMove<T1, T2>&)
+        {
+            ++hits[MOVE_DIFF];
+        }
+
+        template <typename T1, typename T2>
+        void operator()(Move<T1, T2>&)
+        {
+            ++hits[MOVE_DIFF];
+        }
+
+        long total() const
+        {
+            long res = 0;
+            for (long h : hits)
+                res += h;
+            return res;
+        }
+    };
+
+} // namespace step6
@@ -0,0 +1,166 @@
+// Multi-variant visit benchmark: std::visit against misc::visit over 2 to 4
+// vTree arguments, whose alternatives are drawn at random so that the jump
+// cannot be predicted.
+//
+// - dense: a generic visitor, instantiated for every combination.
+// - sparse: a GasMatcher like visitor, with one arm for two Int first and a
+//   catch-all, written with auto for std::visit and with misc::whole for
+//   misc::visit, which shares one function between all the combinations of
+//   the catch-all.
+//
+// Usage: ./bench/visit [N] [ROUNDS]
+
+#include <array>
+#include <cstdio>
+#include <random>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "../cpp-matching-hacks/lib/visit.hh"
+#include "bench.hh"
+#include "tree-plain.hh"
+
+using namespace plain;
+
+using wTree = misc::whole<vTree>;
+
+static int rank(const Mem*)
+{
+    return 0;
+}
+
+static int rank(const Move*)
+{
+    return 1;
+}
+
+static int rank(const Int* i)
+{
+    return 2 + i->val;
+}
+
+/// Every combination counts, as a base 4 number.
+struct Dense
+{
+    template <typename... Ts>
+    int operator()(Ts*... ts) const
+    {
+        int res = 0;
+        ((res = res * 4 + rank(ts)), ...);
+        return res;
+    }
+};
+
+/// Two Int first, or anything else.
+struct SparseAuto
+{
+    template <typename... Ts>
+    int operator()(Int* a, Int* b, Ts*...) const
+    {
+        return a->val + b->val + 1;
+    }
+
+    template <typename... Ts>
+    int operator()(Ts*...) const
+    {
+        return 0;
+    }
+};
+
+struct SparseWhole
+{
+    template <typename... Ws>
+        requires(std::is_same_v<Ws, wTree> && ...)
+    int operator()(Int* a, Int* b, Ws...) const
+    {
+        return a->val + b->val + 1;
+    }
+
+    template <typename... Ws>
+        requires(std::is_same_v<Ws, wTree> && ...)
+    int operator()(Ws...) const
+    {
+        return 0;
+    }
+};
+
+template <std::size_t K>
+using args = std::array<vTree, K>;
+
+template <std::size_t K>
+static std::vector<args<K>> draw(long n, Mem* mem, Move* move, Int* imm)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 2);
+    std::vector<args<K>> res(n);
+    for (auto& a : res)
+        for (auto& v : a)
+        {
+            int d = dist(gen);
+            v = d == 0 ? vTree(mem) : d == 1 ? vTree(move) : vTree(imm);
+        }
+    return res;
+}
+
+template <std::size_t K, typename Visit>
+static long run(const char* name, const std::vector<args<K>>& in,
+                long rounds, Visit visit)
+{
+    long sum = 0;
+    double ms = bench::time_ms([&] {
+        for (long r = 0; r < rounds; ++r)
+            for (const auto& a : in)
+                sum += std::apply(visit, a);
+        bench::do_not_optimize(sum);
+    });
+    std::printf("%zu args %-20s %10.2f ms %8.2f ns/visit\n", K, name, ms,
+                ms * 1e6 / (rounds * in.size()));
+    return sum;
+}
+
+template <std::size_t K>
+static bool bench_args(long n, long rounds, Mem* mem, Move* move, Int* imm)
+{
+    auto in = draw<K>(n, mem, move, imm);
+
+    long dense_std = run<K>("dense std::visit", in, rounds,
+                            [](const auto&... vs) {
+                                return std::visit(Dense(), vs...);
+                            });
+    long dense_misc = run<K>("dense misc::visit", in, rounds,
+                             [](const auto&... vs) {
+                                 return misc::visit(Dense(), vs...);
+                             });
+    long sparse_std = run<K>("sparse std::visit", in, rounds,
+                             [](const auto&... vs) {
+                                 return std::visit(SparseAuto(), vs...);
+                             });
+    long sparse_misc = run<K>("sparse misc::visit", in, rounds,
+                              [](const auto&... vs) {
+                                  return misc::visit(SparseWhole(), vs...);
+                              });
+    return dense_std == dense_misc && sparse_std == sparse_misc;
+}
+
+int main(int argc, char* argv[])
+{
+    long n = bench::arg(argc, argv, 1, 1 << 16);
+    long rounds = bench::arg(argc, argv, 2, 100);
+
+    Int imm(1);
+    Mem mem(&imm);
+    Move move(&mem, &imm);
+
+    if (!bench_args<2>(n, rounds, &mem, &move, &imm)
+        || !bench_args<3>(n, rounds, &mem, &move, &imm)
+        || !bench_args<4>(n, rounds, &mem, &move, &imm))
+    {
+        std::printf("std::visit and misc::visit disagree\n");
+        return 1;
+    }
+
+    return 0;
+}
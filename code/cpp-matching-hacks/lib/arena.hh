@@ -0,0 +1,93 @@
+/**
+ ** \file misc/arena.hh
+ ** \brief Declaration of misc::arena.
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+namespace misc
+{
+    /// A bump-pointer allocator.
+    ///
+    /// Objects are carved out of large chunks, one after the other.  They
+    /// are never freed individually: the whole arena is released at once,
+    /// when it goes out of scope or when \c release() is called.  Only
+    /// trivially destructible objects can be allocated, since their
+    /// destructors are never run.
+    class arena
+    {
+    public:
+        /// Size of the first chunk, subsequent chunks grow geometrically.
+        static constexpr std::size_t default_chunk_size = 64 * 1024;
+
+        /// \name Constructors & Destructor.
+        /// \{
+        /** \brief Construct an empty arena.
+         ** No memory is allocated until the first object is.  Chunks are at
+         ** least alignof(std::max_align_t) bytes. */
+        explicit arena(std::size_t chunk_size = default_chunk_size);
+
+        /** \brief Arenas own their memory, they cannot be copied. */
+        arena(const arena&) = delete;
+        arena& operator=(const arena&) = delete;
+
+        /** \brief Release every chunk. */
+        ~arena();
+        /// \}
+
+        /// \name Allocation.
+        /// \{
+        /** \brief Return \a size bytes of storage aligned on \a align.
+         ** The storage stays valid until the arena is released. */
+        void* allocate(std::size_t size, std::size_t align);
+
+        /** \brief Construct a new \a T in the arena.
+         ** The returned pointer is a non-owning handle: it must not be
+         ** deleted and dangles once the arena is released. */
+        template <typename T, typename... Args>
+        requires std::is_trivially_destructible_v<T> T* make(Args&&... args);
+
+        /** \brief Release all the memory at once.
+         ** No destructor is called, the cost only depends on the number of
+         ** chunks, which grows logarithmically with the allocated size. */
+        void release();
+
+        /** \brief Release every chunk but the current one, the largest, and
+         ** reuse it from its start.
+         ** Meant for arenas refilled right away, such as one per statement:
+         ** once the current chunk is large enough, no memory is allocated. */
+        void reset();
+        /// \}
+
+        /** \brief Number of bytes handed out since the last release. */
+        std::size_t used() const;
+
+    private:
+        /// Header of a chunk, the storage follows it.
+        struct chunk
+        {
+            chunk* next;
+            std::size_t size;
+        };
+
+        /// Allocate a new chunk able to hold \a size bytes aligned on \a
+        /// align, and make it the current one.
+        void grow(std::size_t size, std::size_t align);
+
+        /// Size of the next chunk to allocate.
+        std::size_t chunk_size_;
+        /// The most recently allocated chunk, head of the chunk list.
+        chunk* head_ = nullptr;
+        /// Bump pointer and end of the current chunk.
+        std::byte* cur_ = nullptr;
+        std::byte* end_ = nullptr;
+        /// Bytes handed out.
+        std::size_t used_ = 0;
+    };
+
+} // namespace misc
+
+#include "arena.hxx"
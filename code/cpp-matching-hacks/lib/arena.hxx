@@ -0,0 +1,105 @@
+/**
+ ** \file misc/arena.hxx
+ ** \brief Implementation of misc::arena.
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "arena.hh"
+
+namespace misc
+{
+    /*-----------------.
+    | Ctors and dtor.  |
+    `-----------------*/
+
+    // A null size would never grow
+    inline arena::arena(std::size_t chunk_size)
+        : chunk_size_(std::max(chunk_size, alignof(std::max_align_t)))
+    {}
+
+    inline arena::~arena()
+    {
+        release();
+    }
+
+    /*-------------.
+    | Allocation.  |
+    `-------------*/
+
+    inline void* arena::allocate(std::size_t size, std::size_t align)
+    {
+        auto addr = reinterpret_cast<std::uintptr_t>(cur_);
+        auto aligned = (addr + align - 1) & ~(align - 1);
+        auto padding = aligned - addr;
+
+        if (!cur_ || padding + size > static_cast<std::size_t>(end_ - cur_))
+        {
+            grow(size, align);
+            return allocate(size, align);
+        }
+
+        cur_ += padding + size;
+        used_ += size;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    template <typename T, typename... Args>
+    requires std::is_trivially_destructible_v<T> T* arena::make(
+        Args&&... args)
+    {
+        void* p = allocate(sizeof(T), alignof(T));
+        return new (p) T(std::forward<Args>(args)...);
+    }
+
+    inline void arena::grow(std::size_t size, std::size_t align)
+    {
+        std::size_t needed = size + align;
+        while (chunk_size_ < needed)
+            chunk_size_ *= 2;
+
+        void* raw = ::operator new(sizeof(chunk) + chunk_size_);
+        head_ = new (raw) chunk{head_, chunk_size_};
+        cur_ = reinterpret_cast<std::byte*>(head_ + 1);
+        end_ = cur_ + chunk_size_;
+
+        chunk_size_ *= 2;
+    }
+
+    inline void arena::release()
+    {
+        while (head_)
+        {
+            chunk* next = head_->next;
+            ::operator delete(head_);
+            head_ = next;
+        }
+        cur_ = end_ = nullptr;
+        used_ = 0;
+    }
+
+    inline void arena::reset()
+    {
+        if (!head_)
+            return;
+        chunk* current = head_;
+        head_ = head_->next;
+        release();
+        head_ = current;
+        head_->next = nullptr;
+        cur_ = reinterpret_cast<std::byte*>(head_ + 1);
+        end_ = cur_ + head_->size;
+    }
+
+    inline std::size_t arena::used() const
+    {
+        return used_;
+    }
+
+} // namespace misc
@@ -0,0 +1,161 @@
+/**
+ ** \file misc/burg.hh
+ ** \brief Declaration of misc::burg, a BURG-style instruction selector.
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace misc
+{
+    /// The right-hand side of a BURG rule, such as `Move(Mem(reg), imm)`.
+    ///
+    /// A pattern is either a nonterminal, or a node kind with one
+    /// sub-pattern per child of the node.
+    class burg_pattern
+    {
+    public:
+        /// \name Constructors.
+        /// \{
+        /** \brief Construct a pattern matching nodes of kind \a kind whose
+         ** children match \a children. */
+        burg_pattern(std::size_t kind, std::vector<burg_pattern> children = {});
+
+        /** \brief Construct a pattern matching any node derivable from the
+         ** nonterminal \a nonterm. */
+        static burg_pattern nonterm(std::size_t nonterm);
+        /// \}
+
+        /// \name Accessors.
+        /// \{
+        bool is_nonterm() const;
+        std::size_t nonterm_get() const;
+        std::size_t kind_get() const;
+        const std::vector<burg_pattern>& children_get() const;
+        /// \}
+
+    private:
+        burg_pattern() = default;
+
+        bool is_nonterm_ = false;
+        /// The kind of the node, or the nonterminal.
+        std::size_t value_ = 0;
+        std::vector<burg_pattern> children_;
+    };
+
+    /// A rule `lhs: rhs`, its cost and the code it emits.
+    template <typename Node>
+    struct burg_rule
+    {
+        /// The nonterminal the rule derives.
+        std::size_t lhs;
+        /// What the rule matches.
+        burg_pattern rhs;
+        /// The cost of the rule itself, excluding its nonterminals.
+        int cost;
+        /// Name of the rule, for reports.
+        std::string name;
+        /// Action run on the matched node once its nonterminals are
+        /// reduced, may be empty.
+        std::function<void(const Node&)> emit;
+    };
+
+    /// A bottom-up rewrite system selecting a minimum-cost cover of a tree.
+    ///
+    /// Labeling computes, for every node and nonterminal, the cheapest rule
+    /// deriving the node from the nonterminal by dynamic programming, in a
+    /// single post-order pass: the cost is linear in the size of the tree.
+    /// States are stored in flat tables indexed by post-order number.
+    /// Reducing then runs the actions of the chosen rules, children first.
+    ///
+    /// \a Node must provide \c kind_get(), \c child_count() and \c
+    /// child_get(i), the latter returning a pointer to the \a i th child.
+    template <typename Node>
+    class burg
+    {
+    public:
+        using rule_type = burg_rule<Node>;
+
+        /// Cost of a derivation which does not exist.
+        static constexpr int infinite = std::numeric_limits<int>::max();
+
+        /// Rule index of a derivation which does not exist.
+        static constexpr std::uint16_t no_rule = -1;
+
+        /// Arity of a kind no rule uses.
+        static constexpr std::size_t no_arity = -1;
+
+        /** \brief Build a selector with \a nonterm_count nonterminals.
+         ** Throw std::invalid_argument if a kind is used with different
+         ** arities in \a rules, and std::length_error if there are \c
+         ** no_rule rules or more. */
+        burg(std::size_t nonterm_count, std::vector<rule_type> rules);
+
+        /** \brief Label the tree rooted at \a root, forgetting the previous
+         ** one.
+         ** Throw std::invalid_argument, leaving nothing labeled, if a node
+         ** has another arity than its kind has in the rules. */
+        void label(const Node& root);
+
+        /** \brief Minimum cost of deriving the root from \a nonterm, or \c
+         ** infinite. */
+        int cost(std::size_t nonterm) const;
+
+        /** \brief Rule chosen to derive the root from \a nonterm, or \c
+         ** no_rule. */
+        std::uint16_t rule(std::size_t nonterm) const;
+
+        /** \brief Run the actions of the minimum-cost cover deriving the
+         ** root from \a goal.
+         ** Throw std::runtime_error if there is none. */
+        void reduce(std::size_t goal) const;
+
+        const std::vector<rule_type>& rules_get() const;
+
+    private:
+        /// Label \a node and its children, return the state of \a node.
+        std::uint32_t label_node(const Node& node);
+
+        /// Return the cost of matching \a p against \a state, or \c infinite.
+        int match(const burg_pattern& p, std::uint32_t state) const;
+
+        /// Reduce \a state from \a nonterm.
+        void reduce(std::uint32_t state, std::size_t nonterm) const;
+
+        /// Reduce the nonterminals of \a p, matched against \a state.
+        void reduce_leaves(const burg_pattern& p, std::uint32_t state) const;
+
+        std::size_t nonterm_count_;
+        std::vector<rule_type> rules_;
+        /// Chain rules, `nonterm: nonterm`, tried after the others.
+        std::vector<std::uint16_t> chains_;
+        /// Other rules, indexed by the kind of the root of their pattern.
+        std::vector<std::vector<std::uint16_t>> bases_;
+        /// Number of children of each kind in the rules, \c no_arity for
+        /// kinds they do not use.
+        std::vector<std::size_t> arities_;
+
+        /// \name Per-state tables.
+        /// \{
+        /// The node of each state.
+        std::vector<const Node*> nodes_;
+        /// Offset of the children of each state in \c children_.
+        std::vector<std::uint32_t> first_child_;
+        /// Children states of each state.
+        std::vector<std::uint32_t> children_;
+        /// Costs, \c nonterm_count_ per state.
+        std::vector<int> costs_;
+        /// Chosen rules, \c nonterm_count_ per state.
+        std::vector<std::uint16_t> chosen_;
+        /// \}
+    };
+
+} // namespace misc
+
+#include "burg.hxx"
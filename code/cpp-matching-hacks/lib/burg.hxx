@@ -0,0 +1,271 @@
+/**
+ ** \file misc/burg.hxx
+ ** \brief Implementation of misc::burg.
+ **/
+
+#pragma once
+
+#include <stdexcept>
+#include <utility>
+
+#include "burg.hh"
+
+namespace misc
+{
+    /*---------------.
+    | burg_pattern.  |
+    `---------------*/
+
+    inline burg_pattern::burg_pattern(std::size_t kind,
+                                      std::vector<burg_pattern> children)
+        : value_(kind)
+        , children_(std::move(children))
+    {}
+
+    inline burg_pattern burg_pattern::nonterm(std::size_t nonterm)
+    {
+        burg_pattern res;
+        res.is_nonterm_ = true;
+        res.value_ = nonterm;
+        return res;
+    }
+
+    inline bool burg_pattern::is_nonterm() const
+    {
+        return is_nonterm_;
+    }
+
+    inline std::size_t burg_pattern::nonterm_get() const
+    {
+        return value_;
+    }
+
+    inline std::size_t burg_pattern::kind_get() const
+    {
+        return value_;
+    }
+
+    inline const std::vector<burg_pattern>& burg_pattern::children_get() const
+    {
+        return children_;
+    }
+
+    /*-------.
+    | burg.  |
+    `-------*/
+
+    namespace detail
+    {
+        /// Record in \a arities the number of children of each kind in \a
+        /// p, \a none standing for kinds not seen yet.
+        inline void record_burg_arities(const burg_pattern& p,
+                                        std::vector<std::size_t>& arities,
+                                        std::size_t none)
+        {
+            if (p.is_nonterm())
+                return;
+
+            std::size_t kind = p.kind_get();
+            if (kind >= arities.size())
+                arities.resize(kind + 1, none);
+
+            std::size_t arity = p.children_get().size();
+            if (arities[kind] != none && arities[kind] != arity)
+                throw std::invalid_argument(
+                    "burg: kind used with different arities");
+            arities[kind] = arity;
+
+            for (const auto& child : p.children_get())
+                record_burg_arities(child, arities, none);
+        }
+    } // namespace detail
+
+    template <typename Node>
+    burg<Node>::burg(std::size_t nonterm_count, std::vector<rule_type> rules)
+        : nonterm_count_(nonterm_count)
+        , rules_(std::move(rules))
+    {
+        if (rules_.size() >= no_rule)
+            throw std::length_error("burg: too many rules");
+
+        for (std::size_t r = 0; r < rules_.size(); ++r)
+        {
+            const auto& rhs = rules_[r].rhs;
+            detail::record_burg_arities(rhs, arities_, no_arity);
+            if (rhs.is_nonterm())
+                chains_.push_back(r);
+            else
+            {
+                if (rhs.kind_get() >= bases_.size())
+                    bases_.resize(rhs.kind_get() + 1);
+                bases_[rhs.kind_get()].push_back(r);
+            }
+        }
+    }
+
+    template <typename Node>
+    void burg<Node>::label(const Node& root)
+    {
+        nodes_.clear();
+        first_child_.clear();
+        children_.clear();
+        costs_.clear();
+        chosen_.clear();
+
+        try
+        {
+            label_node(root);
+        }
+        catch (...)
+        {
+            // Leave nothing labeled rather than a part of the tree
+            nodes_.clear();
+            throw;
+        }
+    }
+
+    template <typename Node>
+    std::uint32_t burg<Node>::label_node(const Node& node)
+    {
+        // Patterns read as many children as their kind has in the rules
+        std::size_t kind = static_cast<std::size_t>(node.kind_get());
+        std::size_t arity = node.child_count();
+        if (kind < arities_.size() && arities_[kind] != no_arity
+            && arities_[kind] != arity)
+            throw std::invalid_argument(
+                "burg: node arity differs from the rules");
+
+        // Children first, their states are then available to the patterns
+        std::uint32_t first = children_.size();
+        children_.resize(first + arity);
+        for (std::size_t i = 0; i < arity; ++i)
+        {
+            std::uint32_t child = label_node(*node.child_get(i));
+            children_[first + i] = child;
+        }
+
+        std::uint32_t state = nodes_.size();
+        nodes_.push_back(&node);
+        first_child_.push_back(first);
+        costs_.resize(costs_.size() + nonterm_count_, infinite);
+        chosen_.resize(chosen_.size() + nonterm_count_, no_rule);
+
+        int* costs = &costs_[state * nonterm_count_];
+        std::uint16_t* chosen = &chosen_[state * nonterm_count_];
+
+        if (kind < bases_.size())
+            for (std::uint16_t r : bases_[kind])
+            {
+                const auto& rule = rules_[r];
+                int cost = match(rule.rhs, state);
+                if (cost != infinite && cost + rule.cost < costs[rule.lhs])
+                {
+                    costs[rule.lhs] = cost + rule.cost;
+                    chosen[rule.lhs] = r;
+                }
+            }
+
+        // Close over chain rules until nothing improves
+        for (bool changed = true; changed;)
+        {
+            changed = false;
+            for (std::uint16_t r : chains_)
+            {
+                const auto& rule = rules_[r];
+                int cost = costs[rule.rhs.nonterm_get()];
+                if (cost != infinite && cost + rule.cost < costs[rule.lhs])
+                {
+                    costs[rule.lhs] = cost + rule.cost;
+                    chosen[rule.lhs] = r;
+                    changed = true;
+                }
+            }
+        }
+
+        return state;
+    }
+
+    template <typename Node>
+    int burg<Node>::match(const burg_pattern& p, std::uint32_t state) const
+    {
+        if (p.is_nonterm())
+            return costs_[state * nonterm_count_ + p.nonterm_get()];
+
+        if (static_cast<std::size_t>(nodes_[state]->kind_get()) != p.kind_get())
+            return infinite;
+
+        int res = 0;
+        const auto& children = p.children_get();
+        for (std::size_t i = 0; i < children.size(); ++i)
+        {
+            int cost = match(children[i], children_[first_child_[state] + i]);
+            if (cost == infinite)
+                return infinite;
+            res += cost;
+        }
+        return res;
+    }
+
+    template <typename Node>
+    int burg<Node>::cost(std::size_t nonterm) const
+    {
+        if (nodes_.empty())
+            return infinite;
+        return costs_[(nodes_.size() - 1) * nonterm_count_ + nonterm];
+    }
+
+    template <typename Node>
+    std::uint16_t burg<Node>::rule(std::size_t nonterm) const
+    {
+        if (nodes_.empty())
+            return no_rule;
+        return chosen_[(nodes_.size() - 1) * nonterm_count_ + nonterm];
+    }
+
+    template <typename Node>
+    void burg<Node>::reduce(std::size_t goal) const
+    {
+        if (nodes_.empty())
+            throw std::runtime_error("burg: nothing to reduce");
+        reduce(nodes_.size() - 1, goal);
+    }
+
+    template <typename Node>
+    void burg<Node>::reduce(std::uint32_t state, std::size_t nonterm) const
+    {
+        std::uint16_t r = chosen_[state * nonterm_count_ + nonterm];
+        if (r == no_rule)
+            throw std::runtime_error("burg: no cover for the tree");
+
+        const auto& rule = rules_[r];
+        if (rule.rhs.is_nonterm())
+            reduce(state, rule.rhs.nonterm_get());
+        else
+            reduce_leaves(rule.rhs, state);
+
+        if (rule.emit)
+            rule.emit(*nodes_[state]);
+    }
+
+    template <typename Node>
+    void burg<Node>::reduce_leaves(const burg_pattern& p,
+                                   std::uint32_t state) const
+    {
+        if (p.is_nonterm())
+        {
+            reduce(state, p.nonterm_get());
+            return;
+        }
+
+        const auto& children = p.children_get();
+        for (std::size_t i = 0; i < children.size(); ++i)
+            reduce_leaves(children[i], children_[first_child_[state] + i]);
+    }
+
+    template <typename Node>
+    auto burg<Node>::rules_get() const -> const std::vector<rule_type>&
+    {
+        return rules_;
+    }
+
+} // namespace misc
@@ -0,0 +1,37 @@
+/**
+ ** \file misc/combination.hh
+ ** \brief Declaration of the combinations of alternatives of variants.
+ **
+ ** A combination is the alternatives held by several variants at once,
+ ** numbered in row-major order, the last variant varying fastest.  It
+ ** indexes the flat jump tables of misc::visit and misc::visit_arms.
+ **/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <variant>
+
+namespace misc
+{
+    namespace detail
+    {
+        /// Number of combinations of the alternatives of \a Vs.
+        template <typename... Vs>
+        inline constexpr std::size_t combination_count =
+            (std::variant_size_v<Vs> * ... * 1);
+
+        /** \brief The combination of the alternatives held by \a vs. */
+        template <typename... Vs>
+        std::size_t combination_index(const Vs&... vs);
+
+        /** \brief The alternatives of the combination \a c of \a Vs. */
+        template <typename... Vs>
+        constexpr std::array<std::size_t, sizeof...(Vs)>
+        combination_alternatives(std::size_t c);
+    } // namespace detail
+
+} // namespace misc
+
+#include "combination.hxx"
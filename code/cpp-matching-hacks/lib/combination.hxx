@@ -0,0 +1,38 @@
+/**
+ ** \file misc/combination.hxx
+ ** \brief Implementation of the combinations of alternatives of variants.
+ **/
+
+#pragma once
+
+#include "combination.hh"
+
+namespace misc
+{
+    namespace detail
+    {
+        template <typename... Vs>
+        std::size_t combination_index(const Vs&... vs)
+        {
+            std::size_t res = 0;
+            ((res = res * std::variant_size_v<Vs> + vs.index()), ...);
+            return res;
+        }
+
+        template <typename... Vs>
+        constexpr std::array<std::size_t, sizeof...(Vs)>
+        combination_alternatives(std::size_t c)
+        {
+            constexpr std::array<std::size_t, sizeof...(Vs)> sizes = {
+                std::variant_size_v<Vs>...};
+            std::array<std::size_t, sizeof...(Vs)> res{};
+            for (std::size_t i = sizeof...(Vs); i-- > 0;)
+            {
+                res[i] = c % sizes[i];
+                c /= sizes[i];
+            }
+            return res;
+        }
+    } // namespace detail
+
+} // namespace misc
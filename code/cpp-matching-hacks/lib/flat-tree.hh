@@ -0,0 +1,78 @@
+/**
+ ** \file misc/flat-tree.hh
+ ** \brief Declaration of misc::flat_tree.
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+namespace misc
+{
+    /// An immutable forest stored as a structure of arrays.
+    ///
+    /// Nodes are 32-bit indices into contiguous arrays of kinds, arities and
+    /// operands.  The operand of a node is the offset of its first child in
+    /// the array of child indices, or the offset of its immediate in the
+    /// array of immediates for leaves built with \c add_leaf().
+    ///
+    /// Children are added before their parents, so that nodes are stored in
+    /// post-order and a forward scan of the indices sees every child before
+    /// its parents.  A node may be the child of several parents, which makes
+    /// the forest a DAG.
+    class flat_tree
+    {
+    public:
+        using index_type = std::uint32_t;
+        using kind_type = std::uint8_t;
+        using imm_type = std::int32_t;
+
+        /// \name Construction.
+        /// \{
+        /** \brief Reserve room for \a nodes nodes and \a children children. */
+        void reserve(std::size_t nodes, std::size_t children = 0);
+
+        /** \brief Add a leaf of kind \a kind holding the immediate \a imm. */
+        index_type add_leaf(kind_type kind, imm_type imm);
+
+        /** \brief Add a node of kind \a kind whose children, already added,
+         ** are \a children. */
+        index_type add_node(kind_type kind,
+                            std::initializer_list<index_type> children);
+        index_type add_node(kind_type kind, const index_type* children,
+                            std::size_t arity);
+        /// \}
+
+        /// \name Accessors.
+        /// \{
+        /** \brief Number of nodes. */
+        std::size_t size() const;
+
+        kind_type kind_get(index_type node) const;
+        std::size_t child_count(index_type node) const;
+
+        /** \brief The \a i th child of \a node. */
+        index_type child_get(index_type node, std::size_t i) const;
+
+        /** \brief The immediate of \a node, which must be a leaf built with
+         ** \c add_leaf(). */
+        imm_type imm_get(index_type node) const;
+
+        /** \brief Bytes used by the arrays. */
+        std::size_t memory() const;
+        /// \}
+
+    private:
+        std::vector<kind_type> kinds_;
+        std::vector<std::uint8_t> arities_;
+        std::vector<index_type> operands_;
+        std::vector<index_type> children_;
+        std::vector<imm_type> imms_;
+    };
+
+} // namespace misc
+
+#include "flat-tree.hxx"
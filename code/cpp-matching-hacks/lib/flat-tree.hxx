@@ -0,0 +1,99 @@
+/**
+ ** \file misc/flat-tree.hxx
+ ** \brief Implementation of misc::flat_tree.
+ **/
+
+#pragma once
+
+#include <cassert>
+
+#include "flat-tree.hh"
+
+namespace misc
+{
+    /*---------------.
+    | Construction.  |
+    `---------------*/
+
+    inline void flat_tree::reserve(std::size_t nodes, std::size_t children)
+    {
+        kinds_.reserve(nodes);
+        arities_.reserve(nodes);
+        operands_.reserve(nodes);
+        children_.reserve(children);
+    }
+
+    inline auto flat_tree::add_leaf(kind_type kind, imm_type imm)
+        -> index_type
+    {
+        kinds_.push_back(kind);
+        arities_.push_back(0);
+        operands_.push_back(imms_.size());
+        imms_.push_back(imm);
+        return kinds_.size() - 1;
+    }
+
+    inline auto flat_tree::add_node(kind_type kind,
+                                    std::initializer_list<index_type> children)
+        -> index_type
+    {
+        return add_node(kind, children.begin(), children.size());
+    }
+
+    inline auto flat_tree::add_node(kind_type kind, const index_type* children,
+                                    std::size_t arity) -> index_type
+    {
+        assert(arity <= UINT8_MAX);
+        kinds_.push_back(kind);
+        arities_.push_back(arity);
+        operands_.push_back(children_.size());
+        for (std::size_t i = 0; i < arity; ++i)
+        {
+            assert(children[i] < kinds_.size() - 1);
+            children_.push_back(children[i]);
+        }
+        return kinds_.size() - 1;
+    }
+
+    /*------------.
+    | Accessors.  |
+    `------------*/
+
+    inline std::size_t flat_tree::size() const
+    {
+        return kinds_.size();
+    }
+
+    inline auto flat_tree::kind_get(index_type node) const -> kind_type
+    {
+        return kinds_[node];
+    }
+
+    inline std::size_t flat_tree::child_count(index_type node) const
+    {
+        return arities_[node];
+    }
+
+    inline auto flat_tree::child_get(index_type node, std::size_t i) const
+        -> index_type
+    {
+        assert(i < arities_[node]);
+        return children_[operands_[node] + i];
+    }
+
+    inline auto flat_tree::imm_get(index_type node) const -> imm_type
+    {
+        assert(arities_[node] == 0);
+        return imms_[operands_[node]];
+    }
+
+    inline std::size_t flat_tree::memory() const
+    {
+        return kinds_.size() * sizeof(kind_type)
+            + arities_.size() * sizeof(std::uint8_t)
+            + operands_.size() * sizeof(index_type)
+            + children_.size() * sizeof(index_type)
+            + imms_.size() * sizeof(imm_type);
+    }
+
+} // namespace misc
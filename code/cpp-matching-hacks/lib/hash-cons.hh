@@ -0,0 +1,92 @@
+/**
+ ** \file misc/hash-cons.hh
+ ** \brief Declaration of misc::hash_cons.
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace misc
+{
+    /// A hash-consing node factory.
+    ///
+    /// Nodes are interned by their type and their constructor arguments:
+    /// children are compared by identity and immediates by value, so that
+    /// building a node equal to an existing one returns the existing one.
+    /// Structurally equal trees built by the same factory are therefore the
+    /// same pointer.
+    ///
+    /// The factory holds a reference to every node it built, which lives
+    /// until the factory is cleared or destroyed.  Nodes are built by
+    /// std::make_shared, in one allocation with their counters, and the
+    /// table only holds their indices: its bookkeeping is 51 to 61 bytes per
+    /// distinct node.
+    class hash_cons
+    {
+    public:
+        /** \brief Return the \a T built from \a args, building it only if
+         ** it does not exist yet.  Arguments are smart or raw pointers to
+         ** children, or integral immediates. */
+        template <typename T, typename... Args>
+        requires(sizeof...(Args) <= 2) std::shared_ptr<T> make(
+            const Args&... args);
+
+        /** \brief Reserve room for \a n distinct nodes. */
+        void reserve(std::size_t n);
+
+        /** \brief Number of distinct nodes built. */
+        std::size_t size() const;
+
+        /** \brief Number of calls to \c make(). */
+        std::size_t requests() const;
+
+        /** \brief Drop every reference held by the factory. */
+        void clear();
+
+    private:
+        /// A node type and number of arguments, and the identities of the
+        /// arguments.
+        struct key
+        {
+            const void* type;
+            std::uintptr_t args[2];
+
+            bool operator==(const key&) const = default;
+        };
+
+        /// A slot of the open addressing table: the hash of the key of \a
+        /// node, and its index, \c empty if there is none.  Keys are only
+        /// compared when hashes are equal, and the table is grown without
+        /// looking at them.
+        struct slot
+        {
+            std::uint32_t hash;
+            std::uint32_t node;
+        };
+
+        static constexpr std::uint32_t empty = UINT32_MAX;
+
+        static std::uint32_t hash(const key& k);
+
+        /// Return the slot of \a k, or the empty slot where to insert it.
+        slot& find(const key& k, std::uint32_t h);
+
+        /// Double the number of slots.
+        void grow();
+
+        /// Slots, linearly probed, at most three quarters full.
+        std::vector<slot> slots_;
+        /// Keys of the nodes, in the order they were built.
+        std::vector<key> keys_;
+        /// Nodes, in the order they were built.
+        std::vector<std::shared_ptr<void>> nodes_;
+        std::size_t requests_ = 0;
+    };
+
+} // namespace misc
+
+#include "hash-cons.hxx"
@@ -0,0 +1,133 @@
+/**
+ ** \file misc/hash-cons.hxx
+ ** \brief Implementation of misc::hash_cons.
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "hash-cons.hh"
+
+namespace misc
+{
+    namespace detail
+    {
+        /// The address of type_tag<T, N> identifies \a T built from \a N
+        /// arguments, since unused arguments are null in a key.
+        template <typename T, std::size_t N>
+        inline constexpr char type_tag = 0;
+
+        /// The identity of a constructor argument.
+        template <typename A>
+        std::uintptr_t hash_cons_word(const A& a)
+        {
+            if constexpr (requires { a.get(); })
+                return reinterpret_cast<std::uintptr_t>(a.get());
+            else if constexpr (std::is_pointer_v<A>)
+                return reinterpret_cast<std::uintptr_t>(a);
+            else
+            {
+                static_assert(std::is_integral_v<A> || std::is_enum_v<A>,
+                              "hash_cons: unsupported argument type");
+                return static_cast<std::uintptr_t>(a);
+            }
+        }
+
+    } // namespace detail
+
+    /*------------.
+    | Interning.  |
+    `------------*/
+
+    inline std::uint32_t hash_cons::hash(const key& k)
+    {
+        std::uint64_t h = reinterpret_cast<std::uintptr_t>(k.type);
+        for (auto a : k.args)
+            h = (h ^ a) * 0x9e3779b97f4a7c15ull;
+        return h ^ (h >> 32);
+    }
+
+    inline auto hash_cons::find(const key& k, std::uint32_t h) -> slot&
+    {
+        std::size_t mask = slots_.size() - 1;
+        for (std::size_t i = h & mask;; i = (i + 1) & mask)
+        {
+            slot& s = slots_[i];
+            if (s.node == empty || (s.hash == h && keys_[s.node] == k))
+                return s;
+        }
+    }
+
+    inline void hash_cons::grow()
+    {
+        std::vector<slot> old(std::max<std::size_t>(16, 2 * slots_.size()),
+                              slot{0, empty});
+        old.swap(slots_);
+
+        // Keys are distinct: the first empty slot is the one
+        std::size_t mask = slots_.size() - 1;
+        for (const auto& s : old)
+            if (s.node != empty)
+            {
+                std::size_t i = s.hash & mask;
+                while (slots_[i].node != empty)
+                    i = (i + 1) & mask;
+                slots_[i] = s;
+            }
+    }
+
+    template <typename T, typename... Args>
+    requires(sizeof...(Args) <= 2) std::shared_ptr<T> hash_cons::make(
+        const Args&... args)
+    {
+        ++requests_;
+
+        key k{&detail::type_tag<T, sizeof...(Args)>, {}};
+        [[maybe_unused]] std::size_t i = 0;
+        ((k.args[i++] = detail::hash_cons_word(args)), ...);
+        std::uint32_t h = hash(k);
+
+        if (4 * (nodes_.size() + 1) > 3 * slots_.size())
+            grow();
+        slot& s = find(k, h);
+        if (s.node == empty)
+        {
+            if (nodes_.size() == empty)
+                throw std::length_error("hash_cons: too many nodes");
+            nodes_.push_back(std::make_shared<T>(args...));
+            keys_.push_back(k);
+            s = {h, static_cast<std::uint32_t>(nodes_.size() - 1)};
+        }
+        return std::static_pointer_cast<T>(nodes_[s.node]);
+    }
+
+    inline void hash_cons::reserve(std::size_t n)
+    {
+        keys_.reserve(n);
+        nodes_.reserve(n);
+        while (4 * n > 3 * slots_.size())
+            grow();
+    }
+
+    inline std::size_t hash_cons::size() const
+    {
+        return nodes_.size();
+    }
+
+    inline std::size_t hash_cons::requests() const
+    {
+        return requests_;
+    }
+
+    inline void hash_cons::clear()
+    {
+        slots_.clear();
+        keys_.clear();
+        nodes_.clear();
+        requests_ = 0;
+    }
+
+} // namespace misc
@@ -0,0 +1,93 @@
+/**
+ ** \file misc/intrusive-ptr.hh
+ ** \brief Declaration of misc::ref_counted and misc::intrusive_ptr.
+ **/
+
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <type_traits>
+
+namespace misc
+{
+    /// Base class of objects holding their own reference count.
+    ///
+    /// The count is atomic only if \a Atomic is true, which is only needed
+    /// when references to the same object are copied by several threads.
+    template <bool Atomic = false>
+    class ref_counted
+    {
+    public:
+        using count_type = std::conditional_t<Atomic, std::atomic<long>, long>;
+
+        ref_counted() = default;
+
+        /** \brief Copies of an object are not referenced yet. */
+        ref_counted(const ref_counted&);
+        ref_counted& operator=(const ref_counted&);
+
+        /** \brief Objects are deleted through their base. */
+        virtual ~ref_counted() = default;
+
+        /** \brief Number of references to the object. */
+        long use_count() const;
+
+        /** \brief Add a reference. */
+        void add_ref() const;
+
+        /** \brief Remove a reference, return true if it was the last one. */
+        bool release() const;
+
+    private:
+        mutable count_type count_ = 0;
+    };
+
+    /// A smart pointer to a misc::ref_counted object.
+    ///
+    /// It is a single pointer wide and has no control block: the count is
+    /// stored in the pointee.  Its interface is the subset of the
+    /// std::shared_ptr one misc::ref relies on.
+    template <typename T>
+    class intrusive_ptr
+    {
+    public:
+        using element_type = T;
+
+        /// \name Constructors & Destructor.
+        /// \{
+        /** \brief Take a reference on \a p, which may already be referenced
+         ** by other pointers. */
+        intrusive_ptr(T* p = nullptr);
+
+        intrusive_ptr(const intrusive_ptr& other);
+        intrusive_ptr(intrusive_ptr&& other) noexcept;
+
+        template <typename U>
+        requires std::derived_from<U, T> intrusive_ptr(
+            const intrusive_ptr<U>& other);
+
+        ~intrusive_ptr();
+        /// \}
+
+        intrusive_ptr& operator=(intrusive_ptr other) noexcept;
+
+        /// \name Accessors.
+        /// \{
+        T* get() const;
+        T& operator*() const;
+        T* operator->() const;
+        explicit operator bool() const;
+        long use_count() const;
+        /// \}
+
+        void reset(T* p = nullptr);
+        void swap(intrusive_ptr& other) noexcept;
+
+    private:
+        T* ptr_;
+    };
+
+} // namespace misc
+
+#include "intrusive-ptr.hxx"
@@ -0,0 +1,145 @@
+/**
+ ** \file misc/intrusive-ptr.hxx
+ ** \brief Implementation of misc::ref_counted and misc::intrusive_ptr.
+ **/
+
+#pragma once
+
+#include <utility>
+
+#include "intrusive-ptr.hh"
+
+namespace misc
+{
+    /*--------------.
+    | ref_counted.  |
+    `--------------*/
+
+    template <bool Atomic>
+    ref_counted<Atomic>::ref_counted(const ref_counted&)
+        : count_(0)
+    {}
+
+    template <bool Atomic>
+    ref_counted<Atomic>& ref_counted<Atomic>::operator=(const ref_counted&)
+    {
+        return *this;
+    }
+
+    template <bool Atomic>
+    long ref_counted<Atomic>::use_count() const
+    {
+        if constexpr (Atomic)
+            return count_.load(std::memory_order_relaxed);
+        else
+            return count_;
+    }
+
+    template <bool Atomic>
+    void ref_counted<Atomic>::add_ref() const
+    {
+        if constexpr (Atomic)
+            count_.fetch_add(1, std::memory_order_relaxed);
+        else
+            ++count_;
+    }
+
+    template <bool Atomic>
+    bool ref_counted<Atomic>::release() const
+    {
+        if constexpr (Atomic)
+            return count_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        else
+            return --count_ == 0;
+    }
+
+    /*-----------------.
+    | Ctors and dtor.  |
+    `-----------------*/
+
+    template <typename T>
+    intrusive_ptr<T>::intrusive_ptr(T* p)
+        : ptr_(p)
+    {
+        if (ptr_)
+            ptr_->add_ref();
+    }
+
+    template <typename T>
+    intrusive_ptr<T>::intrusive_ptr(const intrusive_ptr& other)
+        : intrusive_ptr(other.ptr_)
+    {}
+
+    template <typename T>
+    intrusive_ptr<T>::intrusive_ptr(intrusive_ptr&& other) noexcept
+        : ptr_(std::exchange(other.ptr_, nullptr))
+    {}
+
+    template <typename T>
+    template <typename U>
+    requires std::derived_from<U, T> intrusive_ptr<T>::intrusive_ptr(
+        const intrusive_ptr<U>& other)
+        : intrusive_ptr(other.get())
+    {}
+
+    template <typename T>
+    intrusive_ptr<T>::~intrusive_ptr()
+    {
+        if (ptr_ && ptr_->release())
+            delete ptr_;
+    }
+
+    template <typename T>
+    intrusive_ptr<T>& intrusive_ptr<T>::operator=(intrusive_ptr other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    /*------------.
+    | Accessors.  |
+    `------------*/
+
+    template <typename T>
+    T* intrusive_ptr<T>::get() const
+    {
+        return ptr_;
+    }
+
+    template <typename T>
+    T& intrusive_ptr<T>::operator*() const
+    {
+        return *ptr_;
+    }
+
+    template <typename T>
+    T* intrusive_ptr<T>::operator->() const
+    {
+        return ptr_;
+    }
+
+    template <typename T>
+    intrusive_ptr<T>::operator bool() const
+    {
+        return ptr_;
+    }
+
+    template <typename T>
+    long intrusive_ptr<T>::use_count() const
+    {
+        return ptr_ ? ptr_->use_count() : 0;
+    }
+
+    template <typename T>
+    void intrusive_ptr<T>::reset(T* p)
+    {
+        intrusive_ptr(p).swap(*this);
+    }
+
+    template <typename T>
+    void intrusive_ptr<T>::swap(intrusive_ptr& other) noexcept
+    {
+        std::swap(ptr_, other.ptr_);
+    }
+
+} // namespace misc
@@ -0,0 +1,96 @@
+/**
+ ** \file misc/kind-classifier.hh
+ ** \brief Declaration of misc::shape and misc::kind_classifier.
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "flat-tree.hh"
+
+namespace misc
+{
+    /// Instruction sets the kernels of misc::kind_classifier may use.
+    enum class simd_level
+    {
+        scalar,
+        sse2,
+        avx2,
+    };
+
+    /** \brief The best level supported by the running CPU. */
+    simd_level simd_support();
+
+    /** \brief The name of \a level. */
+    const char* simd_name(simd_level level);
+
+    /// The top of a pattern: the kind of its root and those of its first two
+    /// children, any of which may be a wildcard.  `Move(Int, _)` is the
+    /// shape of `Move(Int, Mem(_))`.
+    struct shape
+    {
+        using kind_type = flat_tree::kind_type;
+
+        /// The wildcard.
+        static constexpr kind_type any = 0xff;
+
+        kind_type kind = any;
+        kind_type first = any;
+        kind_type second = any;
+    };
+
+    /// Classifier of nodes by the shapes of a rule set.
+    ///
+    /// The mask of a node has a bit per shape, set if the node and its
+    /// children have the kinds of the shape: only the rules of these shapes
+    /// may match the node, and only they go through full matching.  Nodes
+    /// are classified by blocks, a kind compared per byte lane, with AVX2
+    /// or SSE2 when the CPU supports them, and in 64-bit words otherwise.
+    class kind_classifier
+    {
+    public:
+        using kind_type = flat_tree::kind_type;
+
+        /// One bit per shape, the first shape being the lowest.
+        using mask_type = std::uint8_t;
+
+        /// Maximum number of shapes.
+        static constexpr std::size_t max_shapes = 8;
+
+        /// The kind of a missing child.
+        static constexpr kind_type none = 0xfe;
+
+        /// Number of nodes of a misc::flat_tree classified at once.
+        static constexpr std::size_t batch = 32;
+
+        /** \brief Classify by \a shapes, with \a level at most.
+         ** Throw std::length_error if there are more than \c max_shapes
+         ** shapes. */
+        kind_classifier(const std::vector<shape>& shapes,
+                        simd_level level = simd_support());
+
+        /** \brief Write to \a masks the masks of \a n nodes, given their
+         ** \a kinds and those of their \a firsts and \a seconds children,
+         ** \c none for missing ones. */
+        void classify(const kind_type* kinds, const kind_type* firsts,
+                      const kind_type* seconds, std::size_t n,
+                      mask_type* masks) const;
+
+        /** \brief Fill \a masks with the masks of the nodes of \a tree. */
+        void classify(const flat_tree& tree,
+                      std::vector<mask_type>& masks) const;
+
+        /** \brief The level of the kernel in use. */
+        simd_level level_get() const;
+
+    private:
+        std::vector<shape> shapes_;
+        simd_level level_;
+    };
+
+} // namespace misc
+
+#include "kind-classifier.hxx"
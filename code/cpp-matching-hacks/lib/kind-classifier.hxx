@@ -0,0 +1,277 @@
+/**
+ ** \file misc/kind-classifier.hxx
+ ** \brief Implementation of misc::shape and misc::kind_classifier.
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "kind-classifier.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <immintrin.h>
+#endif
+
+namespace misc
+{
+    /*-------------.
+    | simd_level.  |
+    `-------------*/
+
+    inline simd_level simd_support()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return simd_level::avx2;
+        if (__builtin_cpu_supports("sse2"))
+            return simd_level::sse2;
+#endif
+        return simd_level::scalar;
+    }
+
+    inline const char* simd_name(simd_level level)
+    {
+        switch (level)
+        {
+        case simd_level::avx2:
+            return "avx2";
+        case simd_level::sse2:
+            return "sse2";
+        default:
+            return "scalar";
+        }
+    }
+
+    /*------------------.
+    | kind_classifier.  |
+    `------------------*/
+
+    namespace detail
+    {
+        using classifier_mask = kind_classifier::mask_type;
+
+        /// The masks of \a n nodes, one at a time.
+        inline void classify_each(const std::vector<shape>& shapes,
+                                  const shape::kind_type* kinds,
+                                  const shape::kind_type* firsts,
+                                  const shape::kind_type* seconds,
+                                  std::size_t n, classifier_mask* masks)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                classifier_mask m = 0;
+                for (std::size_t r = 0; r < shapes.size(); ++r)
+                {
+                    const shape& s = shapes[r];
+                    bool hit = (s.kind == shape::any || s.kind == kinds[i])
+                        && (s.first == shape::any || s.first == firsts[i])
+                        && (s.second == shape::any || s.second == seconds[i]);
+                    m |= classifier_mask(hit) << r;
+                }
+                masks[i] = m;
+            }
+        }
+
+        /// The high bit of each byte of \a w which is \a k, the others
+        /// cleared.
+        inline std::uint64_t swar_equal(std::uint64_t w, shape::kind_type k)
+        {
+            constexpr std::uint64_t ones = 0x0101010101010101;
+            constexpr std::uint64_t low = 0x7f * ones;
+            std::uint64_t x = w ^ (k * ones);
+            // No carry crosses bytes, unlike with the usual (x - ones)
+            return ~(((x & low) + low) | x | low);
+        }
+
+        /// The masks of \a n nodes, 8 at a time in 64-bit words.
+        inline void classify_scalar(const std::vector<shape>& shapes,
+                                    const shape::kind_type* kinds,
+                                    const shape::kind_type* firsts,
+                                    const shape::kind_type* seconds,
+                                    std::size_t n, classifier_mask* masks)
+        {
+            constexpr std::uint64_t high = 0x8080808080808080;
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                std::uint64_t k, f, s;
+                std::memcpy(&k, kinds + i, 8);
+                std::memcpy(&f, firsts + i, 8);
+                std::memcpy(&s, seconds + i, 8);
+
+                std::uint64_t res = 0;
+                for (std::size_t r = 0; r < shapes.size(); ++r)
+                {
+                    const shape& sh = shapes[r];
+                    std::uint64_t m = high;
+                    if (sh.kind != shape::any)
+                        m &= swar_equal(k, sh.kind);
+                    if (sh.first != shape::any)
+                        m &= swar_equal(f, sh.first);
+                    if (sh.second != shape::any)
+                        m &= swar_equal(s, sh.second);
+                    res |= (m >> 7) << r;
+                }
+                std::memcpy(masks + i, &res, 8);
+            }
+            classify_each(shapes, kinds + i, firsts + i, seconds + i, n - i,
+                          masks + i);
+        }
+
+#if defined(__x86_64__) || defined(__i386__)
+        // A lane of a comparison is all ones where the kinds are equal: the
+        // lanes of a shape are ANDed, then masked by its bit and ORed into
+        // the masks of the block.
+
+        /// The masks of \a n nodes, 16 at a time.
+        __attribute__((target("sse2"))) inline void
+        classify_sse2(const std::vector<shape>& shapes,
+                      const shape::kind_type* kinds,
+                      const shape::kind_type* firsts,
+                      const shape::kind_type* seconds, std::size_t n,
+                      classifier_mask* masks)
+        {
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16)
+            {
+                using v = __m128i;
+                v k = _mm_loadu_si128(reinterpret_cast<const v*>(kinds + i));
+                v f = _mm_loadu_si128(reinterpret_cast<const v*>(firsts + i));
+                v s = _mm_loadu_si128(reinterpret_cast<const v*>(seconds + i));
+
+                __m128i res = _mm_setzero_si128();
+                for (std::size_t r = 0; r < shapes.size(); ++r)
+                {
+                    const shape& sh = shapes[r];
+                    __m128i m = _mm_set1_epi8(char(1 << r));
+                    if (sh.kind != shape::any)
+                        m = _mm_and_si128(
+                            m, _mm_cmpeq_epi8(k, _mm_set1_epi8(sh.kind)));
+                    if (sh.first != shape::any)
+                        m = _mm_and_si128(
+                            m, _mm_cmpeq_epi8(f, _mm_set1_epi8(sh.first)));
+                    if (sh.second != shape::any)
+                        m = _mm_and_si128(
+                            m, _mm_cmpeq_epi8(s, _mm_set1_epi8(sh.second)));
+                    res = _mm_or_si128(res, m);
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(masks + i), res);
+            }
+            classify_scalar(shapes, kinds + i, firsts + i, seconds + i,
+                            n - i, masks + i);
+        }
+
+        /// The masks of \a n nodes, 32 at a time.
+        __attribute__((target("avx2"))) inline void
+        classify_avx2(const std::vector<shape>& shapes,
+                      const shape::kind_type* kinds,
+                      const shape::kind_type* firsts,
+                      const shape::kind_type* seconds, std::size_t n,
+                      classifier_mask* masks)
+        {
+            std::size_t i = 0;
+            for (; i + 32 <= n; i += 32)
+            {
+                using v = __m256i;
+                v k = _mm256_loadu_si256(reinterpret_cast<const v*>(kinds + i));
+                v f =
+                    _mm256_loadu_si256(reinterpret_cast<const v*>(firsts + i));
+                v s =
+                    _mm256_loadu_si256(reinterpret_cast<const v*>(seconds + i));
+
+                __m256i res = _mm256_setzero_si256();
+                for (std::size_t r = 0; r < shapes.size(); ++r)
+                {
+                    const shape& sh = shapes[r];
+                    __m256i m = _mm256_set1_epi8(char(1 << r));
+                    if (sh.kind != shape::any)
+                        m = _mm256_and_si256(
+                            m,
+                            _mm256_cmpeq_epi8(k, _mm256_set1_epi8(sh.kind)));
+                    if (sh.first != shape::any)
+                        m = _mm256_and_si256(
+                            m,
+                            _mm256_cmpeq_epi8(f, _mm256_set1_epi8(sh.first)));
+                    if (sh.second != shape::any)
+                        m = _mm256_and_si256(
+                            m,
+                            _mm256_cmpeq_epi8(s,
+                                              _mm256_set1_epi8(sh.second)));
+                    res = _mm256_or_si256(res, m);
+                }
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(masks + i),
+                                    res);
+            }
+            classify_sse2(shapes, kinds + i, firsts + i, seconds + i, n - i,
+                          masks + i);
+        }
+#endif
+    } // namespace detail
+
+    inline kind_classifier::kind_classifier(const std::vector<shape>& shapes,
+                                            simd_level level)
+        : shapes_(shapes)
+        , level_(std::min(level, simd_support()))
+    {
+        if (shapes.size() > max_shapes)
+            throw std::length_error("kind_classifier: too many shapes");
+    }
+
+    inline void kind_classifier::classify(const kind_type* kinds,
+                                          const kind_type* firsts,
+                                          const kind_type* seconds,
+                                          std::size_t n,
+                                          mask_type* masks) const
+    {
+        switch (level_)
+        {
+#if defined(__x86_64__) || defined(__i386__)
+        case simd_level::avx2:
+            detail::classify_avx2(shapes_, kinds, firsts, seconds, n, masks);
+            break;
+        case simd_level::sse2:
+            detail::classify_sse2(shapes_, kinds, firsts, seconds, n, masks);
+            break;
+#endif
+        default:
+            detail::classify_scalar(shapes_, kinds, firsts, seconds, n,
+                                    masks);
+        }
+    }
+
+    inline void kind_classifier::classify(const flat_tree& tree,
+                                          std::vector<mask_type>& masks) const
+    {
+        masks.resize(tree.size());
+
+        // Children are anywhere before their parents: gather their kinds
+        kind_type kinds[batch];
+        kind_type firsts[batch];
+        kind_type seconds[batch];
+        for (std::size_t begin = 0; begin < tree.size(); begin += batch)
+        {
+            std::size_t n = std::min(batch, tree.size() - begin);
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                flat_tree::index_type node = begin + j;
+                std::size_t arity = tree.child_count(node);
+                kinds[j] = tree.kind_get(node);
+                firsts[j] =
+                    arity > 0 ? tree.kind_get(tree.child_get(node, 0)) : none;
+                seconds[j] =
+                    arity > 1 ? tree.kind_get(tree.child_get(node, 1)) : none;
+            }
+            classify(kinds, firsts, seconds, n, masks.data() + begin);
+        }
+    }
+
+    inline simd_level kind_classifier::level_get() const
+    {
+        return level_;
+    }
+
+} // namespace misc
@@ -0,0 +1,99 @@
+/**
+ ** \file misc/lambda-visitor.hh
+ ** \brief Declaration of misc::LambdaVisitor.
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+namespace misc
+{
+    /// The type of the argument of the call operator of \a L, if it is not
+    /// a template and takes a single argument.
+    template <typename L>
+    struct call_argument
+    {};
+
+    template <typename L>
+    requires requires
+    {
+        &L::operator();
+    }
+    struct call_argument<L> : call_argument<decltype(&L::operator())>
+    {};
+
+    template <typename C, typename R, typename A>
+    struct call_argument<R (C::*)(A) const>
+    {
+        using type = std::remove_cvref_t<A>;
+    };
+
+    template <typename C, typename R, typename A>
+    struct call_argument<R (C::*)(A)>
+    {
+        using type = std::remove_cvref_t<A>;
+    };
+
+    /// Whether \a L is a catch-all reached by \a T: a lambda whose call
+    /// operator is not a template, and takes an argument of another type to
+    /// which \a T converts.
+    template <typename L, typename T>
+    concept catch_all_for = requires
+    {
+        typename call_argument<L>::type;
+    }
+    &&!std::is_same_v<typename call_argument<L>::type, std::remove_cvref_t<T>>
+        && std::is_invocable_v<const L&, T>;
+
+    /// Whether \a T reaches nothing but a catch-all among \a Ls.
+    template <typename T, typename... Ls>
+    inline constexpr bool only_catch_all_v =
+        (std::size_t(std::is_invocable_v<const Ls&, T>) + ... + 0) == 1
+        && (catch_all_for<Ls, T> || ...);
+
+    /// An overload set of lambdas, to be visited with std::visit or
+    /// misc::visit.
+    ///
+    /// A catch-all is a lambda whose call operator is not a template and
+    /// takes one argument, to which alternatives convert: typically a
+    /// pointer to the base class of the nodes, as in [](const sTree& t).
+    ///
+    /// Alternatives which reach nothing but a catch-all are detected at
+    /// compile time.  The entry of the jump table of such an alternative
+    /// only converts it to the argument of the catch-all and, unless the
+    /// argument is trivially destructible, calls a function shared by all
+    /// of them, which calls the catch-all and destroys the argument.  Thus
+    /// the dispatch is a single jump, and the bulk of the code is generated
+    /// once rather than per alternative.
+    template <typename... Ls>
+    class LambdaVisitor
+    {
+        struct overloads : Ls...
+        {
+            using Ls::operator()...;
+        };
+
+    public:
+        LambdaVisitor(Ls... ls);
+
+        /** \brief Call the overload set with \a ts. */
+        template <typename... Ts>
+        requires std::is_invocable_v<const overloads&, Ts...>
+        decltype(auto) operator()(Ts&&... ts) const;
+
+    private:
+        /** \brief Call the catch-all, the only lambda \a t reaches. */
+        template <typename T>
+        decltype(auto) catch_all(T&& t) const;
+
+        overloads ls_;
+    };
+
+    template <typename... Ls>
+    LambdaVisitor(Ls...) -> LambdaVisitor<Ls...>;
+
+} // namespace misc
+
+#include "lambda-visitor.hxx"
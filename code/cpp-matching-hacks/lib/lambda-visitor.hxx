@@ -0,0 +1,92 @@
+/**
+ ** \file misc/lambda-visitor.hxx
+ ** \brief Implementation of misc::LambdaVisitor.
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "lambda-visitor.hh"
+
+namespace misc
+{
+    namespace detail
+    {
+        /// Index of the first of \a Ls callable with \a T.
+        template <typename T, typename... Ls>
+        constexpr std::size_t callable_index()
+        {
+            std::size_t res = -1;
+            std::size_t i = 0;
+            ((res = res == std::size_t(-1) && std::is_invocable_v<const Ls&, T>
+                  ? i
+                  : res,
+              ++i),
+             ...);
+            return res;
+        }
+
+        /// Call \a l with \a a, then destroy \a a: the argument of a
+        /// catch-all, built by the caller.  Not inlined, so that callers
+        /// only build the argument, whatever its destructor.
+        template <typename L, typename A>
+        [[gnu::noinline]] decltype(auto) call_catch_all(const L& l, A& a)
+        {
+            struct destroy
+            {
+                A& a;
+
+                ~destroy()
+                {
+                    a.~A();
+                }
+            } guard{a};
+            return l(std::move(a));
+        }
+    } // namespace detail
+
+    template <typename... Ls>
+    LambdaVisitor<Ls...>::LambdaVisitor(Ls... ls)
+        : ls_{std::move(ls)...}
+    {}
+
+    template <typename... Ls>
+    template <typename... Ts>
+    requires std::is_invocable_v<
+        const typename LambdaVisitor<Ls...>::overloads&, Ts...>
+    decltype(auto) LambdaVisitor<Ls...>::operator()(Ts&&... ts) const
+    {
+        if constexpr (sizeof...(Ts) == 1
+                      && (only_catch_all_v<Ts, Ls...> && ...))
+            return catch_all(std::forward<Ts>(ts)...);
+        else
+            return ls_(std::forward<Ts>(ts)...);
+    }
+
+    template <typename... Ls>
+    template <typename T>
+    decltype(auto) LambdaVisitor<Ls...>::catch_all(T&& t) const
+    {
+        using catch_all =
+            std::tuple_element_t<detail::callable_index<T, Ls...>(),
+                                 std::tuple<Ls...>>;
+        using arg = typename call_argument<catch_all>::type;
+
+        const auto& l = static_cast<const catch_all&>(ls_);
+        if constexpr (std::is_trivially_destructible_v<arg>)
+            return l(arg(std::forward<T>(t)));
+        else
+        {
+            // The upcast, the only code specific to the alternative
+            alignas(arg) unsigned char storage[sizeof(arg)];
+            arg* a = new (storage) arg(std::forward<T>(t));
+            return detail::call_catch_all(l, *a);
+        }
+    }
+
+} // namespace misc
@@ -0,0 +1,62 @@
+/**
+ ** \file misc/lazy-variant.hh
+ ** \brief Declaration of misc::lazy_variant.
+ **/
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace misc
+{
+    /// A lazy view of a child node, as passed to the arms of a visitor.
+    ///
+    /// Building a node's variant() costs a virtual call and a reference
+    /// count increment, and arms often dispatch on a single child of the
+    /// node.  A lazy_variant only builds the variant of its node the first
+    /// time an arm asks for it, and then keeps it, so that the children an
+    /// arm does not inspect cost nothing.  It does not own its node, which
+    /// must outlive it.
+    template <typename T>
+    class lazy_variant
+    {
+    public:
+        using node_type = T;
+        using variant_type =
+            std::remove_cvref_t<decltype(std::declval<T&>().variant())>;
+
+        /** \brief A view of \a node, whose variant is not built yet. */
+        explicit lazy_variant(T& node);
+
+        /// \name Accessors.
+        /// \{
+        /** \brief The node itself, without building its variant. */
+        T& node_get() const;
+        T* operator->() const;
+
+        /** \brief The variant of the node, built on the first call. */
+        const variant_type& variant() const;
+
+        /** \brief Whether the variant of the node was built. */
+        bool materialized() const;
+        /// \}
+
+        /** \brief Visit the variant of the node with \a f. */
+        template <typename F>
+        decltype(auto) visit(F&& f) const;
+
+    private:
+        T* node_;
+        mutable std::optional<variant_type> variant_;
+    };
+
+    /** \brief A lazy view of the node \a p points to. */
+    template <typename T>
+    lazy_variant<T> lazy(const std::shared_ptr<T>& p);
+
+} // namespace misc
+
+#include "lazy-variant.hxx"
@@ -0,0 +1,68 @@
+/**
+ ** \file misc/lazy-variant.hxx
+ ** \brief Implementation of misc::lazy_variant.
+ **/
+
+#pragma once
+
+#include <cassert>
+#include <variant>
+
+#include "lazy-variant.hh"
+
+namespace misc
+{
+    template <typename T>
+    lazy_variant<T>::lazy_variant(T& node)
+        : node_(&node)
+    {}
+
+    /*------------.
+    | Accessors.  |
+    `------------*/
+
+    template <typename T>
+    T& lazy_variant<T>::node_get() const
+    {
+        return *node_;
+    }
+
+    template <typename T>
+    T* lazy_variant<T>::operator->() const
+    {
+        return node_;
+    }
+
+    template <typename T>
+    auto lazy_variant<T>::variant() const -> const variant_type&
+    {
+        if (!variant_)
+            variant_.emplace(node_->variant());
+        return *variant_;
+    }
+
+    template <typename T>
+    bool lazy_variant<T>::materialized() const
+    {
+        return variant_.has_value();
+    }
+
+    /*-----------.
+    | Visiting.  |
+    `-----------*/
+
+    template <typename T>
+    template <typename F>
+    decltype(auto) lazy_variant<T>::visit(F&& f) const
+    {
+        return std::visit(std::forward<F>(f), variant());
+    }
+
+    template <typename T>
+    lazy_variant<T> lazy(const std::shared_ptr<T>& p)
+    {
+        assert(p);
+        return lazy_variant<T>(*p);
+    }
+
+} // namespace misc
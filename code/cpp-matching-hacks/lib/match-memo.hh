@@ -0,0 +1,90 @@
+/**
+ ** \file misc/match-memo.hh
+ ** \brief Declaration of misc::match_memo.
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace misc
+{
+    /// A side table of match results keyed by node identity.
+    ///
+    /// Matching a DAG node by node through a match_memo matches a shared
+    /// subtree once, however many parents it has.  Results only hold during
+    /// a pass: nodes may be freed or rewritten afterwards, and their
+    /// addresses reused.  A pass is thus a match_memo::pass, which clears
+    /// the table when it ends, and the matchers using the table take the
+    /// pass rather than the table itself.
+    template <typename V>
+    class match_memo
+    {
+    public:
+        using key_type = const void*;
+
+        /// A pass over the table, which is cleared when the pass ends,
+        /// however it ends.  The table may be reused by the next pass.
+        class pass
+        {
+        public:
+            explicit pass(match_memo& memo);
+            ~pass();
+
+            pass(const pass&) = delete;
+            pass& operator=(const pass&) = delete;
+
+            /** \brief The table, valid until the end of the pass. */
+            match_memo& memo_get() const;
+
+        private:
+            match_memo& memo_;
+        };
+
+        /** \brief The result of \a node, or null if it is unknown. */
+        const V* find(key_type node);
+
+        /** \brief Record that the result of \a node, which must be unknown,
+         ** is \a value. */
+        void insert(key_type node, const V& value);
+
+        /** \brief The result of \a node, computed by \a compute() if it is
+         ** unknown.  \a compute may match other nodes through the table. */
+        template <typename F>
+        V get(key_type node, F&& compute);
+
+        /** \brief Reserve room for the results of \a n nodes. */
+        void reserve(std::size_t n);
+
+        /** \brief Number of nodes with a known result. */
+        std::size_t size() const;
+
+        /** \brief Number of lookups of known and unknown nodes. */
+        std::size_t hits() const;
+        std::size_t misses() const;
+
+        /** \brief Forget every result, as a pass does when it ends. */
+        void clear();
+
+    private:
+        /// A slot of the open addressing table, empty if \a node is null.
+        struct slot
+        {
+            key_type node;
+            V value;
+        };
+
+        slot& lookup(key_type node);
+        void grow();
+
+        /// Slots, linearly probed, at most half full.
+        std::vector<slot> slots_;
+        std::size_t size_ = 0;
+        std::size_t hits_ = 0;
+        std::size_t misses_ = 0;
+    };
+
+} // namespace misc
+
+#include "match-memo.hxx"
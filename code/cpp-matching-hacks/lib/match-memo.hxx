@@ -0,0 +1,140 @@
+/**
+ ** \file misc/match-memo.hxx
+ ** \brief Implementation of misc::match_memo.
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+#include "match-memo.hh"
+
+namespace misc
+{
+    /*----------.
+    | Lookups.  |
+    `----------*/
+
+    template <typename V>
+    auto match_memo<V>::lookup(key_type node) -> slot&
+    {
+        auto h = reinterpret_cast<std::uintptr_t>(node) * 0x9e3779b97f4a7c15ull;
+        std::size_t mask = slots_.size() - 1;
+        for (std::size_t i = (h >> 32) & mask;; i = (i + 1) & mask)
+        {
+            slot& s = slots_[i];
+            if (!s.node || s.node == node)
+                return s;
+        }
+    }
+
+    template <typename V>
+    void match_memo<V>::grow()
+    {
+        std::vector<slot> old(std::max<std::size_t>(16, 2 * slots_.size()));
+        old.swap(slots_);
+        for (const auto& s : old)
+            if (s.node)
+                lookup(s.node) = s;
+    }
+
+    template <typename V>
+    const V* match_memo<V>::find(key_type node)
+    {
+        if (!slots_.empty())
+        {
+            slot& s = lookup(node);
+            if (s.node)
+            {
+                ++hits_;
+                return &s.value;
+            }
+        }
+        ++misses_;
+        return nullptr;
+    }
+
+    template <typename V>
+    void match_memo<V>::insert(key_type node, const V& value)
+    {
+        assert(node);
+        if (2 * (size_ + 1) > slots_.size())
+            grow();
+        slot& s = lookup(node);
+        assert(!s.node);
+        s = {node, value};
+        ++size_;
+    }
+
+    template <typename V>
+    template <typename F>
+    V match_memo<V>::get(key_type node, F&& compute)
+    {
+        if (const V* res = find(node))
+            return *res;
+        // compute() may insert other nodes and move the slots.
+        V res = compute();
+        insert(node, res);
+        return res;
+    }
+
+    template <typename V>
+    void match_memo<V>::reserve(std::size_t n)
+    {
+        while (2 * n > slots_.size())
+            grow();
+    }
+
+    /*------------.
+    | Accessors.  |
+    `------------*/
+
+    template <typename V>
+    std::size_t match_memo<V>::size() const
+    {
+        return size_;
+    }
+
+    template <typename V>
+    std::size_t match_memo<V>::hits() const
+    {
+        return hits_;
+    }
+
+    template <typename V>
+    std::size_t match_memo<V>::misses() const
+    {
+        return misses_;
+    }
+
+    template <typename V>
+    void match_memo<V>::clear()
+    {
+        slots_.clear();
+        size_ = hits_ = misses_ = 0;
+    }
+
+    /*-------.
+    | pass.  |
+    `-------*/
+
+    template <typename V>
+    match_memo<V>::pass::pass(match_memo& memo)
+        : memo_(memo)
+    {}
+
+    template <typename V>
+    match_memo<V>::pass::~pass()
+    {
+        memo_.clear();
+    }
+
+    template <typename V>
+    match_memo<V>& match_memo<V>::pass::memo_get() const
+    {
+        return memo_;
+    }
+
+} // namespace misc
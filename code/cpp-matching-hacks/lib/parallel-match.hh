@@ -0,0 +1,59 @@
+/**
+ ** \file misc/parallel-match.hh
+ ** \brief Declaration of misc::parallel_match.
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "ref-fixed.hh"
+
+namespace misc
+{
+    /// Whether copies of a \a T can be made and destroyed by several
+    /// threads at once, which is the case of everything but misc::ref with
+    /// a non-atomic count.  Only the top-level references are checked.
+    template <typename T>
+    struct is_thread_safe : std::true_type
+    {};
+
+    template <typename T, typename Policy>
+    struct is_thread_safe<ref<T, Policy>>
+        : std::bool_constant<Policy::thread_safe>
+    {};
+
+    template <typename... Ts>
+    struct is_thread_safe<std::variant<Ts...>>
+        : std::conjunction<is_thread_safe<Ts>...>
+    {};
+
+    template <typename T>
+    constexpr bool is_thread_safe_v = is_thread_safe<T>::value;
+
+    /// Match every tree of \a roots on a work-stealing pool of \a threads
+    /// threads, the calling one included, and return the concatenation of
+    /// their outputs in the order of \a roots.
+    ///
+    /// Roots are split in chunks of \a grain trees, initially distributed
+    /// evenly among the workers.  A worker matches its own chunks first,
+    /// then steals from the others.  `f(root, out)` appends the outputs of
+    /// a tree to `out`, a buffer private to the worker, so that nothing but
+    /// the chunk queues is shared.  \a f is called concurrently, and
+    /// subtrees shared between roots must be reference counted atomically.
+    ///
+    /// If \a threads is 0, std::thread::hardware_concurrency() threads are
+    /// used.  If \a f throws, the first exception is rethrown once every
+    /// worker is done.
+    template <typename R, typename T, typename F>
+    requires is_thread_safe_v<T> std::vector<R>
+    parallel_match(std::span<const T> roots, F&& f, unsigned threads = 0,
+                   std::size_t grain = 64);
+
+} // namespace misc
+
+#include "parallel-match.hxx"
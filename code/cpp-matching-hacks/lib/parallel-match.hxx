@@ -0,0 +1,152 @@
+/**
+ ** \file misc/parallel-match.hxx
+ ** \brief Implementation of misc::parallel_match.
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <thread>
+
+#include "parallel-match.hh"
+
+namespace misc
+{
+    namespace detail
+    {
+        /// The chunks [begin, end) left to a worker.  The owner takes them
+        /// from the front, thieves from the back.
+        struct alignas(64) chunk_queue
+        {
+            std::mutex mutex;
+            std::size_t begin = 0;
+            std::size_t end = 0;
+        };
+
+        /// Outputs [begin, end) of a worker come from chunk \a chunk.
+        struct chunk_span
+        {
+            std::size_t chunk;
+            std::size_t begin;
+            std::size_t end;
+        };
+
+        /// The private buffer of a worker.
+        template <typename R>
+        struct alignas(64) worker_output
+        {
+            std::vector<R> out;
+            std::vector<chunk_span> spans;
+            std::exception_ptr error;
+        };
+
+        /// Take the next chunk of worker \a self, or steal one, into \a
+        /// chunk.  Return false once every queue is empty.
+        inline bool next_chunk(std::vector<chunk_queue>& queues,
+                               std::size_t self, std::size_t& chunk)
+        {
+            {
+                chunk_queue& q = queues[self];
+                std::lock_guard lock(q.mutex);
+                if (q.begin < q.end)
+                {
+                    chunk = q.begin++;
+                    return true;
+                }
+            }
+
+            for (std::size_t i = 1; i < queues.size(); ++i)
+            {
+                chunk_queue& q = queues[(self + i) % queues.size()];
+                std::lock_guard lock(q.mutex);
+                if (q.begin < q.end)
+                {
+                    chunk = --q.end;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    } // namespace detail
+
+    template <typename R, typename T, typename F>
+    requires is_thread_safe_v<T> std::vector<R>
+    parallel_match(std::span<const T> roots, F&& f, unsigned threads,
+                   std::size_t grain)
+    {
+        grain = std::max<std::size_t>(grain, 1);
+        std::size_t chunks = (roots.size() + grain - 1) / grain;
+        if (!threads)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        std::size_t workers =
+            std::clamp<std::size_t>(chunks, 1, threads);
+
+        std::vector<detail::chunk_queue> queues(workers);
+        for (std::size_t w = 0; w < workers; ++w)
+        {
+            queues[w].begin = chunks * w / workers;
+            queues[w].end = chunks * (w + 1) / workers;
+        }
+
+        std::vector<detail::worker_output<R>> outputs(workers);
+        auto work = [&](std::size_t self) {
+            detail::worker_output<R>& o = outputs[self];
+            try
+            {
+                std::size_t chunk;
+                while (detail::next_chunk(queues, self, chunk))
+                {
+                    std::size_t begin = o.out.size();
+                    std::size_t first = chunk * grain;
+                    std::size_t last = std::min(first + grain, roots.size());
+                    for (std::size_t i = first; i < last; ++i)
+                        f(roots[i], o.out);
+                    o.spans.push_back({chunk, begin, o.out.size()});
+                }
+            }
+            catch (...)
+            {
+                o.error = std::current_exception();
+            }
+        };
+
+        {
+            std::vector<std::jthread> pool;
+            pool.reserve(workers - 1);
+            for (std::size_t w = 1; w < workers; ++w)
+                pool.emplace_back(work, w);
+            work(0);
+        }
+
+        for (auto& o : outputs)
+            if (o.error)
+                std::rethrow_exception(o.error);
+
+        // Concatenate the outputs in the order of the chunks.
+        std::vector<std::pair<std::size_t, const detail::chunk_span*>> where(
+            chunks);
+        std::size_t size = 0;
+        for (std::size_t w = 0; w < workers; ++w)
+            for (const auto& s : outputs[w].spans)
+            {
+                where[s.chunk] = {w, &s};
+                size += s.end - s.begin;
+            }
+
+        std::vector<R> res;
+        res.reserve(size);
+        for (const auto& [w, s] : where)
+        {
+            auto out = outputs[w].out.begin();
+            res.insert(res.end(), std::make_move_iterator(out + s->begin),
+                       std::make_move_iterator(out + s->end));
+        }
+        return res;
+    }
+
+} // namespace misc
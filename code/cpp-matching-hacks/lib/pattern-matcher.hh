@@ -0,0 +1,134 @@
+/**
+ ** \file misc/pattern-matcher.hh
+ ** \brief Declaration of misc::pattern and misc::pattern_matcher.
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace misc
+{
+    /// A destructuring pattern on trees, such as `Move(Mem(_), Int)`.
+    ///
+    /// A pattern is either the wildcard, or a node kind with one sub-pattern
+    /// per child of the node.
+    class pattern
+    {
+    public:
+        /// The kind of the wildcard.
+        static constexpr std::size_t any_kind = -1;
+
+        /// \name Constructors.
+        /// \{
+        /** \brief Construct the wildcard pattern. */
+        pattern() = default;
+
+        /** \brief Construct a pattern matching nodes of kind \a kind whose
+         ** children match \a children. */
+        pattern(std::size_t kind, std::vector<pattern> children = {});
+        /// \}
+
+        /// \name Accessors.
+        /// \{
+        std::size_t kind_get() const;
+        const std::vector<pattern>& children_get() const;
+        bool is_any() const;
+        /// \}
+
+    private:
+        std::size_t kind_ = any_kind;
+        std::vector<pattern> children_;
+    };
+
+    /// The wildcard pattern, `_` in OCaml.
+    inline const pattern _;
+
+    /// A set of patterns compiled into a decision tree.
+    ///
+    /// Matching tests the kind of each node at most once, with a single table
+    /// lookup per test, whatever the number of patterns.  The first pattern
+    /// of the set which matches wins, as in an OCaml match.
+    ///
+    /// \a Node must provide:
+    ///  - a static \c kind_count constant, the number of node kinds;
+    ///  - a \c kind_get() method returning the kind of the node;
+    ///  - a \c child_get(i) method returning a pointer to its \a i th child.
+    template <typename Node>
+    class pattern_matcher
+    {
+    public:
+        /// Index returned when no pattern matches.
+        static constexpr int no_match = -1;
+
+        /// Maximum number of nodes under test at once.
+        static constexpr std::size_t max_width = 32;
+
+        /** \brief Compile \a patterns.
+         ** Throw std::invalid_argument if a kind is used with different
+         ** arities, and std::length_error if matching would need more than
+         ** \c max_width columns. */
+        pattern_matcher(const std::vector<pattern>& patterns);
+
+        /** \brief Return the index of the first pattern matching \a node, or
+         ** \c no_match. */
+        int match(const Node& node) const;
+
+        /** \brief Number of states of the decision tree. */
+        std::size_t size() const;
+
+    private:
+        /// A row of the clause matrix: the patterns still to be matched,
+        /// one per column, and the index of the rule.
+        struct row
+        {
+            std::vector<const pattern*> cols;
+            int rule;
+        };
+
+        /// A state of the decision tree, either a leaf or a test.
+        struct state
+        {
+            /// The matched rule, for leaves.
+            int rule;
+            /// The tested column, for tests.
+            std::uint32_t column;
+            /// Offset of the first transition of a test, leaves have none.
+            std::uint32_t transitions;
+        };
+
+        /// What to do once a column has been tested.
+        struct transition
+        {
+            /// Next state.
+            std::uint32_t next;
+            /// Whether to replace the column by the children of its node,
+            /// or to drop it.
+            bool expand;
+        };
+
+        /// Build the state for \a rows, whose width is \a width.
+        std::uint32_t build(const std::vector<row>& rows, std::size_t width);
+
+        /// Rows of \a rows which still apply once \a column is known to be of
+        /// kind \a kind, with the column replaced by its children.
+        std::vector<row> specialize(const std::vector<row>& rows,
+                                    std::size_t column, std::size_t kind) const;
+
+        /// Rows of \a rows with a wildcard in \a column, without it.
+        std::vector<row> drop(const std::vector<row>& rows,
+                              std::size_t column) const;
+
+        /// Number of children of each kind, as seen in the patterns.
+        std::vector<std::size_t> arities_;
+        /// The decision tree, its root is the first state.
+        std::vector<state> states_;
+        /// Transitions of the tests, \c Node::kind_count per test.
+        std::vector<transition> transitions_;
+    };
+
+} // namespace misc
+
+#include "pattern-matcher.hxx"
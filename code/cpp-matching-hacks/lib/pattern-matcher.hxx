@@ -0,0 +1,225 @@
+/**
+ ** \file misc/pattern-matcher.hxx
+ ** \brief Implementation of misc::pattern and misc::pattern_matcher.
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+
+#include "pattern-matcher.hh"
+
+namespace misc
+{
+    /*----------.
+    | pattern.  |
+    `----------*/
+
+    inline pattern::pattern(std::size_t kind, std::vector<pattern> children)
+        : kind_(kind)
+        , children_(std::move(children))
+    {}
+
+    inline std::size_t pattern::kind_get() const
+    {
+        return kind_;
+    }
+
+    inline const std::vector<pattern>& pattern::children_get() const
+    {
+        return children_;
+    }
+
+    inline bool pattern::is_any() const
+    {
+        return kind_ == any_kind;
+    }
+
+    /*------------------.
+    | pattern_matcher.  |
+    `------------------*/
+
+    namespace detail
+    {
+        /// Offset of the transitions of a leaf.
+        inline constexpr std::uint32_t leaf = -1;
+
+        /// Record in \a arities the number of children of each kind in \a p.
+        inline void record_arities(const pattern& p,
+                                   std::vector<std::size_t>& arities)
+        {
+            if (p.is_any())
+                return;
+
+            std::size_t kind = p.kind_get();
+            if (kind >= arities.size())
+                throw std::invalid_argument("pattern_matcher: unknown kind");
+
+            std::size_t arity = p.children_get().size();
+            if (arities[kind] != pattern::any_kind && arities[kind] != arity)
+                throw std::invalid_argument(
+                    "pattern_matcher: kind used with different arities");
+            arities[kind] = arity;
+
+            for (const auto& child : p.children_get())
+                record_arities(child, arities);
+        }
+    } // namespace detail
+
+    template <typename Node>
+    pattern_matcher<Node>::pattern_matcher(const std::vector<pattern>& patterns)
+        : arities_(Node::kind_count, pattern::any_kind)
+    {
+        std::vector<row> rows;
+        for (std::size_t i = 0; i < patterns.size(); ++i)
+        {
+            detail::record_arities(patterns[i], arities_);
+            rows.push_back({{&patterns[i]}, static_cast<int>(i)});
+        }
+
+        build(rows, 1);
+    }
+
+    template <typename Node>
+    std::uint32_t pattern_matcher<Node>::build(const std::vector<row>& rows,
+                                               std::size_t width)
+    {
+        if (width > max_width)
+            throw std::length_error("pattern_matcher: patterns too wide");
+
+        std::uint32_t id = states_.size();
+
+        if (rows.empty())
+        {
+            states_.push_back({no_match, 0, detail::leaf});
+            return id;
+        }
+
+        // Test the first column the first row is not a wildcard for
+        const auto& first = rows.front().cols;
+        std::uint32_t column = 0;
+        while (column < width && first[column]->is_any())
+            ++column;
+
+        if (column == width)
+        {
+            states_.push_back({rows.front().rule, 0, detail::leaf});
+            return id;
+        }
+
+        std::uint32_t offset = transitions_.size();
+        states_.push_back({no_match, column, offset});
+        transitions_.resize(offset + Node::kind_count);
+
+        std::vector<bool> heads(Node::kind_count);
+        for (const auto& r : rows)
+            if (!r.cols[column]->is_any())
+                heads[r.cols[column]->kind_get()] = true;
+
+        // All kinds absent from the column share the same default state
+        std::optional<std::uint32_t> fallback;
+        for (std::size_t kind = 0; kind < Node::kind_count; ++kind)
+            if (heads[kind])
+            {
+                auto next = build(specialize(rows, column, kind),
+                                  width - 1 + arities_[kind]);
+                transitions_[offset + kind] = {next, true};
+            }
+            else
+            {
+                if (!fallback)
+                    fallback = build(drop(rows, column), width - 1);
+                transitions_[offset + kind] = {*fallback, false};
+            }
+
+        return id;
+    }
+
+    template <typename Node>
+    auto pattern_matcher<Node>::specialize(const std::vector<row>& rows,
+                                           std::size_t column,
+                                           std::size_t kind) const
+        -> std::vector<row>
+    {
+        std::vector<row> res;
+        for (const auto& r : rows)
+        {
+            const pattern* p = r.cols[column];
+            if (!p->is_any() && p->kind_get() != kind)
+                continue;
+
+            row spec{{r.cols.begin(), r.cols.begin() + column}, r.rule};
+            if (p->is_any())
+                spec.cols.insert(spec.cols.end(), arities_[kind], &_);
+            else
+                for (const auto& child : p->children_get())
+                    spec.cols.push_back(&child);
+            spec.cols.insert(spec.cols.end(), r.cols.begin() + column + 1,
+                             r.cols.end());
+            res.push_back(std::move(spec));
+        }
+        return res;
+    }
+
+    template <typename Node>
+    auto pattern_matcher<Node>::drop(const std::vector<row>& rows,
+                                     std::size_t column) const
+        -> std::vector<row>
+    {
+        std::vector<row> res;
+        for (const auto& r : rows)
+            if (r.cols[column]->is_any())
+            {
+                row dropped = r;
+                dropped.cols.erase(dropped.cols.begin() + column);
+                res.push_back(std::move(dropped));
+            }
+        return res;
+    }
+
+    template <typename Node>
+    int pattern_matcher<Node>::match(const Node& node) const
+    {
+        const Node* cols[max_width];
+        std::size_t width = 1;
+        cols[0] = &node;
+
+        const state* s = &states_[0];
+        while (s->transitions != detail::leaf)
+        {
+            const Node* n = cols[s->column];
+            std::size_t kind = static_cast<std::size_t>(n->kind_get());
+            const transition& t = transitions_[s->transitions + kind];
+
+            if (t.expand && arities_[kind] > 0)
+            {
+                // Replace the column by the children of its node
+                std::size_t arity = arities_[kind];
+                std::copy_backward(cols + s->column + 1, cols + width,
+                                   cols + width + arity - 1);
+                for (std::size_t i = 0; i < arity; ++i)
+                    cols[s->column + i] = n->child_get(i);
+                width += arity - 1;
+            }
+            else
+            {
+                // Drop the column, leaves have no children to replace it
+                std::copy(cols + s->column + 1, cols + width,
+                          cols + s->column);
+                --width;
+            }
+
+            s = &states_[t.next];
+        }
+        return s->rule;
+    }
+
+    template <typename Node>
+    std::size_t pattern_matcher<Node>::size() const
+    {
+        return states_.size();
+    }
+
+} // namespace misc
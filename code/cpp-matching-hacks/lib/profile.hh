@@ -0,0 +1,51 @@
+/**
+ ** \file misc/profile.hh
+ ** \brief Declaration of misc::profiled.
+ **
+ ** Instrumentation of visitors, enabled by defining MISC_PROFILE.  Without
+ ** it, misc::profiled returns a copy of its argument, as the class template
+ ** holds one, and nothing else is defined: the code generated is the same as
+ ** without the wrapper.
+ **/
+
+#pragma once
+
+#include <type_traits>
+
+namespace misc
+{
+#ifdef MISC_PROFILE
+    /// A visitor counting the calls to \a F and the cycles spent in them, for
+    /// each combination of argument types, i.e. for each overload of \a F
+    /// which may fire.
+    ///
+    /// Counters are thread-local: a call only touches the counters of its
+    /// thread.  They are merged when their thread exits, and a report of all
+    /// of them sorted by number of hits is written to std::cerr at exit.
+    template <typename F>
+    class profiled
+    {
+    public:
+        explicit profiled(F f);
+
+        template <typename... Ts>
+        decltype(auto) operator()(Ts&&... ts);
+
+        template <typename... Ts>
+        decltype(auto) operator()(Ts&&... ts) const;
+
+    private:
+        F f_;
+    };
+
+    template <typename F>
+    profiled(F) -> profiled<F>;
+#else
+    /** \brief Without MISC_PROFILE, a copy of \a f. */
+    template <typename F>
+    std::decay_t<F> profiled(F&& f);
+#endif
+
+} // namespace misc
+
+#include "profile.hxx"
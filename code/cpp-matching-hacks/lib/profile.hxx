@@ -0,0 +1,222 @@
+/**
+ ** \file misc/profile.hxx
+ ** \brief Implementation of misc::profiled.
+ **/
+
+#pragma once
+
+#include <utility>
+
+#include "profile.hh"
+
+#ifdef MISC_PROFILE
+#    include <algorithm>
+#    include <chrono>
+#    include <cstdint>
+#    include <deque>
+#    include <iomanip>
+#    include <iostream>
+#    include <mutex>
+#    include <string>
+#    include <string_view>
+#    include <vector>
+
+#    if defined(__x86_64__) || defined(__i386__)
+#        include <x86intrin.h>
+#    endif
+#endif
+
+namespace misc
+{
+#ifdef MISC_PROFILE
+    namespace detail
+    {
+        /// The time stamp counter, or a nanosecond clock where there is
+        /// none.
+        inline std::uint64_t cycles()
+        {
+#    if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#    else
+            return std::chrono::steady_clock::now().time_since_epoch().count();
+#    endif
+        }
+
+        /// The names of \a Ts, from the signature of the function.
+        template <typename... Ts>
+        std::string type_names()
+        {
+            // "[with Ts = {...}; ...]" for g++, "[Ts = <...>]" for clang++
+            std::string_view res = __PRETTY_FUNCTION__;
+            auto first = res.find("Ts = ");
+            if (first == res.npos)
+                return std::string(res);
+            res.remove_prefix(first + 5);
+            res = res.substr(0, std::min(res.find("; "), res.rfind(']')));
+            return std::string(res.substr(1, res.size() - 2));
+        }
+
+        /*-------------------.
+        | profile_counters.  |
+        `-------------------*/
+
+        /// The counters of an overload.
+        struct profile_counters
+        {
+            std::string name;
+            std::uint64_t hits = 0;
+            std::uint64_t cycles = 0;
+        };
+
+        /*-----------------.
+        | profile_report.  |
+        `-----------------*/
+
+        /// The counters merged by exited threads, reported at exit.
+        class profile_report
+        {
+        public:
+            static profile_report& get()
+            {
+                static profile_report res;
+                return res;
+            }
+
+            void merge(const std::deque<profile_counters>& counters)
+            {
+                std::lock_guard lock(mutex_);
+                for (const auto& c : counters)
+                {
+                    auto it = std::find_if(
+                        counters_.begin(), counters_.end(),
+                        [&](const auto& d) { return d.name == c.name; });
+                    if (it == counters_.end())
+                        counters_.push_back(c);
+                    else
+                    {
+                        it->hits += c.hits;
+                        it->cycles += c.cycles;
+                    }
+                }
+            }
+
+            ~profile_report()
+            {
+                std::stable_sort(counters_.begin(), counters_.end(),
+                                 [](const auto& a, const auto& b) {
+                                     return a.hits > b.hits;
+                                 });
+                std::cerr << "misc::profiled: " << std::setw(10) << "hits"
+                          << std::setw(14) << "cycles" << std::setw(10)
+                          << "cyc/hit"
+                          << "  overload\n";
+                for (const auto& c : counters_)
+                    std::cerr << "misc::profiled: " << std::setw(10) << c.hits
+                              << std::setw(14) << c.cycles << std::setw(10)
+                              << c.cycles / c.hits << "  " << c.name << '\n';
+            }
+
+        private:
+            std::mutex mutex_;
+            std::vector<profile_counters> counters_;
+        };
+
+        /*----------------.
+        | profile_table.  |
+        `----------------*/
+
+        /// The counters of every overload called by a thread.
+        class profile_table
+        {
+        public:
+            /// The table of the current thread.
+            static profile_table& local()
+            {
+                // Construct the report first, so that it outlives the table
+                // of the main thread.
+                profile_report::get();
+                thread_local profile_table res;
+                return res;
+            }
+
+            /// Counters that live as long as the thread.
+            profile_counters& add(std::string name)
+            {
+                return counters_.emplace_back(std::move(name));
+            }
+
+            /// Merge the counters into the process wide report.
+            ~profile_table()
+            {
+                profile_report::get().merge(counters_);
+            }
+
+        private:
+            // A deque, so that counters do not move.
+            std::deque<profile_counters> counters_;
+        };
+
+        /// The counters of \a F called with \a Ts in the current thread.
+        template <typename F, typename... Ts>
+        profile_counters& counters_of()
+        {
+            thread_local profile_counters& res = profile_table::local().add(
+                type_names<F>() + "(" + type_names<Ts...>() + ")");
+            return res;
+        }
+
+        /// Count a call, and the cycles until the end of the scope.
+        class profile_scope
+        {
+        public:
+            explicit profile_scope(profile_counters& counters)
+                : counters_(counters)
+                , start_(cycles())
+            {
+                ++counters_.hits;
+            }
+
+            ~profile_scope()
+            {
+                counters_.cycles += cycles() - start_;
+            }
+
+        private:
+            profile_counters& counters_;
+            std::uint64_t start_;
+        };
+    } // namespace detail
+
+    /*-----------.
+    | profiled.  |
+    `-----------*/
+
+    template <typename F>
+    profiled<F>::profiled(F f)
+        : f_(std::move(f))
+    {}
+
+    template <typename F>
+    template <typename... Ts>
+    decltype(auto) profiled<F>::operator()(Ts&&... ts)
+    {
+        detail::profile_scope scope(detail::counters_of<F, Ts...>());
+        return f_(std::forward<Ts>(ts)...);
+    }
+
+    template <typename F>
+    template <typename... Ts>
+    decltype(auto) profiled<F>::operator()(Ts&&... ts) const
+    {
+        detail::profile_scope scope(detail::counters_of<F, Ts...>());
+        return f_(std::forward<Ts>(ts)...);
+    }
+#else
+    template <typename F>
+    std::decay_t<F> profiled(F&& f)
+    {
+        return std::forward<F>(f);
+    }
+#endif
+
+} // namespace misc
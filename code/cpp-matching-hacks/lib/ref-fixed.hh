@@ -5,22 +5,97 @@
 
 #pragma once
 
+#include <concepts>
 #include <memory>
 
+#include "intrusive-ptr.hh"
+
 namespace misc
 {
-    /// A std::shared_ptr wrapper.
+    /// Reference counting through std::shared_ptr, the default.
+    struct shared_policy
+    {
+        template <typename T>
+        using pointer_type = std::shared_ptr<T>;
+
+        /// Whether references can be copied concurrently.
+        static constexpr bool thread_safe = true;
+
+        /// Whether a \a T can be counted by the policy.
+        template <typename T>
+        static constexpr bool accepts = true;
+
+        /// Share the ownership of \a p as a \a U, or return null.
+        template <typename U, typename T>
+        static pointer_type<U> dynamic_cast_to(const pointer_type<T>& p);
+
+        /// Share the ownership of \a p, which must be a \a U, as a \a U.
+        template <typename U, typename T>
+        static pointer_type<U> static_cast_to(const pointer_type<T>& p);
+    };
+
+    /// Reference counting through a count stored in the objects, which must
+    /// derive from misc::ref_counted<Atomic>.
+    ///
+    /// References are a single pointer wide, there is no control block, and
+    /// the count is not atomic unless \a Atomic is true.
+    template <bool Atomic = false>
+    struct intrusive_policy
+    {
+        template <typename T>
+        using pointer_type = intrusive_ptr<T>;
+
+        static constexpr bool thread_safe = Atomic;
+
+        /// Only objects holding a count of the same atomicity, so that
+        /// \c thread_safe holds.
+        template <typename T>
+        static constexpr bool accepts =
+            std::derived_from<T, ref_counted<Atomic>>;
+
+        /// Share the ownership of \a p as a \a U, or return null.
+        template <typename U, typename T>
+        static pointer_type<U> dynamic_cast_to(const pointer_type<T>& p);
+
+        /// Share the ownership of \a p, which must be a \a U, as a \a U.
+        template <typename U, typename T>
+        static pointer_type<U> static_cast_to(const pointer_type<T>& p);
+    };
+
+    /// Whether \a U opts in to constant time type tests from a \a T.
+    ///
+    /// As in LLVM, `U::classof(t)` tells whether \a t is really a \a U,
+    /// usually by checking that its kind lies in the range of kinds of the
+    /// subclasses of \a U (see misc::in_kind_range).  Types which do not opt
+    /// in are tested with dynamic_cast.
+    template <typename U, typename T>
+    concept classof_from = std::derived_from<U, T> && requires(const T* t)
+    {
+        {
+            U::classof(t)
+            } -> std::convertible_to<bool>;
+        static_cast<const U*>(t);
+    };
+
+    /// Whether \a kind lies in [\a First, \a Last], to implement classof.
+    template <auto First, auto Last = First>
+    constexpr bool in_kind_range(decltype(First) kind);
+
+    /// A smart pointer wrapper.
     ///
     /// Compared to its super type, this implementation provides
-    /// cast operators, and implicit constructors.
-    template <typename T>
-    class ref : public std::shared_ptr<T>
+    /// cast operators, and implicit constructors.  The super type is
+    /// chosen by \a Policy, std::shared_ptr by default.
+    template <typename T, typename Policy = shared_policy>
+    class ref : public Policy::template pointer_type<T>
     {
     public:
         /// The parent class.
-        using super_type = std::shared_ptr<T>;
+        using super_type = typename Policy::template pointer_type<T>;
         /// The type pointed to.
         using element_type = T;
+        /// The reference counting policy.
+        using policy_type = Policy;
 
         /// \name Constructors & Destructor.
         /// \{
@@ -29,7 +104,7 @@ namespace misc
          ** The new reference shares the property of the object with \a other.
          */
         template <typename U>
-        requires std::derived_from<U, T> ref(const ref<U>& other);
+        requires std::derived_from<U, T> ref(const ref<U, Policy>& other);
 
         /** \brief Copy constructor.
          **
@@ -38,12 +113,13 @@ namespace misc
          ** signature.  Otherwise, the compiler will provide a default
          ** implementation, which is of course wrong.  Note that the
          ** same applies for the assignment operator. */
-        ref(const ref<T>& other);
+        ref(const ref<T, Policy>& other);
 
         /** \brief Construct a counted reference to a newly allocated object.
          ** The new reference takes the property of the object pointed to
          ** by \a p.  If \a p is null, then the reference is invalid and
-         ** must be \c reset() before use. */
+         ** must be \c reset() before use.  \a T must be accepted by \a
+         ** Policy. */
         ref(T* p = nullptr);
 
         /// \name Equality operators.
@@ -63,7 +139,7 @@ namespace misc
         /// \{
 
         /** \brief Use default copy-assignment operator. */
-        ref<T>& operator=(const ref<T>& r) = default;
+        ref<T, Policy>& operator=(const ref<T, Policy>& r) = default;
 
         /// \}
 
@@ -75,19 +151,22 @@ namespace misc
          ** dynamic_cast is invalid.
          **/
         template <typename U>
-        ref<U> cast() const;
+        ref<U, Policy> cast() const;
 
         /** \brief Cast the reference (unsafe).
          ** Return a new reference, possibly a null reference if the
          ** dynamic_cast is invalid.
          **/
         template <typename U>
-        ref<U> unsafe_cast() const;
+        ref<U, Policy> unsafe_cast() const;
         /// \}
 
         /** \brief Test fellowship.
          ** Return true if the reference points to an object which is
          ** really of the specified type.
+         **
+         ** Casts and tests use \c U::classof when \a U satisfies
+         ** misc::classof_from, and dynamic_cast otherwise.
          **/
         template <typename U>
         bool is_a() const;
@@ -12,38 +12,83 @@
 
 namespace misc
 {
+    /*-----------.
+    | Policies.  |
+    `-----------*/
+
+    template <typename U, typename T>
+    auto shared_policy::dynamic_cast_to(const pointer_type<T>& p)
+        -> pointer_type<U>
+    {
+        return std::dynamic_pointer_cast<U>(p);
+    }
+
+    template <typename U, typename T>
+    auto shared_policy::static_cast_to(const pointer_type<T>& p)
+        -> pointer_type<U>
+    {
+        return std::static_pointer_cast<U>(p);
+    }
+
+    template <bool Atomic>
+    template <typename U, typename T>
+    auto intrusive_policy<Atomic>::dynamic_cast_to(const pointer_type<T>& p)
+        -> pointer_type<U>
+    {
+        return dynamic_cast<U*>(p.get());
+    }
+
+    template <bool Atomic>
+    template <typename U, typename T>
+    auto intrusive_policy<Atomic>::static_cast_to(const pointer_type<T>& p)
+        -> pointer_type<U>
+    {
+        return static_cast<U*>(p.get());
+    }
+
+    template <auto First, auto Last>
+    constexpr bool in_kind_range(decltype(First) kind)
+    {
+        return First <= kind && kind <= Last;
+    }
+
     /*-----------------.
     | Ctors and dtor.  |
     `-----------------*/
 
-    template <typename T>
+    template <typename T, typename Policy>
     template <typename U>
-    requires std::derived_from<U, T> ref<T>::ref(const ref<U>& other)
+    requires std::derived_from<U, T> ref<T, Policy>::ref(
+        const ref<U, Policy>& other)
         : super_type(other)
     {}
 
-    template <typename T>
-    ref<T>::ref(const ref<T>& other)
+    template <typename T, typename Policy>
+    ref<T, Policy>::ref(const ref<T, Policy>& other)
         : super_type(other)
     {}
 
-    template <typename T>
-    ref<T>::ref(T* p)
+    template <typename T, typename Policy>
+    ref<T, Policy>::ref(T* p)
         : super_type(p)
-    {}
+    {
+        // Checked here rather than on the class, where T may be incomplete
+        static_assert(Policy::template accepts<T>,
+                      "misc::ref: the policy cannot count this type");
+    }
 
     /*---------------------.
     | Equality operators.  |
     `---------------------*/
 
-    template <typename T>
-    bool ref<T>::operator==(const T* other) const
+    template <typename T, typename Policy>
+    bool ref<T, Policy>::operator==(const T* other) const
     {
         return this->get() == other;
     }
 
-    template <typename T>
-    bool ref<T>::operator!=(const T* other) const
+    template <typename T, typename Policy>
+    bool ref<T, Policy>::operator!=(const T* other) const
     {
         return !(*this == other);
     }
@@ -52,29 +97,40 @@ namespace misc
     | Casts.  |
     `--------*/
 
-    template <typename T>
+    template <typename T, typename Policy>
     template <typename U>
-    ref<U> ref<T>::unsafe_cast() const
+    ref<U, Policy> ref<T, Policy>::unsafe_cast() const
     {
-        ref<U> res;
-        (std::dynamic_pointer_cast<U, element_type>(*this)).swap(res);
+        ref<U, Policy> res;
+        if constexpr (classof_from<U, T>)
+        {
+            if (is_a<U>())
+                (Policy::template static_cast_to<U, element_type>(*this))
+                    .swap(res);
+        }
+        else
+            (Policy::template dynamic_cast_to<U, element_type>(*this))
+                .swap(res);
         return res;
     }
 
-    template <typename T>
+    template <typename T, typename Policy>
     template <typename U>
-    ref<U> ref<T>::cast() const
+    ref<U, Policy> ref<T, Policy>::cast() const
     {
         if (!this->get() || !this->is_a<U>())
             throw std::bad_cast();
         return unsafe_cast<U>();
     }
 
-    template <typename T>
+    template <typename T, typename Policy>
     template <typename U>
-    bool ref<T>::is_a() const
+    bool ref<T, Policy>::is_a() const
     {
-        return dynamic_cast<U*>(this->get());
+        if constexpr (classof_from<U, T>)
+            return this->get() && U::classof(this->get());
+        else
+            return dynamic_cast<U*>(this->get());
     }
 
 } // namespace misc
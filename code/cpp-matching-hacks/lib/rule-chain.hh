@@ -0,0 +1,81 @@
+/**
+ ** \file misc/rule-chain.hh
+ ** \brief Declaration of misc::rule_chain.
+ **/
+
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "pattern-matcher.hh"
+#include "rule-profile.hh"
+
+namespace misc
+{
+    /// A set of patterns tried one after the other, as the chain of tests
+    /// of a hand-written matcher.
+    ///
+    /// The first pattern of the set which matches wins, as with
+    /// misc::pattern_matcher.  Yet two patterns which cannot match the same
+    /// tree may be tried in any order: given a misc::rule_profile, the chain
+    /// tries the hottest patterns first, so that most nodes are matched by
+    /// the first tests, which are then well predicted.  A pattern is never
+    /// tried before an earlier one it overlaps.
+    ///
+    /// \a Node must provide:
+    ///  - a \c kind_get() method returning the kind of the node;
+    ///  - a \c child_get(i) method returning a pointer to its \a i th child.
+    template <typename Node>
+    class rule_chain
+    {
+    public:
+        /// Index returned when no pattern matches.
+        static constexpr int no_match = -1;
+
+        /// \name Constructors.
+        /// \{
+        /** \brief Try \a patterns in their order. */
+        rule_chain(const std::vector<pattern>& patterns);
+
+        /** \brief Try \a patterns by decreasing number of hits in \a
+         ** profile, as far as the first match allows.
+         ** Throw std::invalid_argument if \a profile is not a profile of
+         ** \a patterns. */
+        rule_chain(const std::vector<pattern>& patterns,
+                   const rule_profile& profile);
+
+        /** \brief Try \a patterns in the order \a order, the indices of the
+         ** patterns, such as one saved by write_order().
+         ** Throw std::invalid_argument if \a order is not a permutation,
+         ** or if it tries a pattern before an earlier one it overlaps. */
+        rule_chain(const std::vector<pattern>& patterns,
+                   const std::vector<int>& order);
+        /// \}
+
+        /** \brief Return the index of the first pattern matching \a node, or
+         ** \c no_match. */
+        int match(const Node& node) const;
+
+        /** \brief The indices of the patterns, in the order they are
+         ** tried. */
+        const std::vector<int>& order_get() const;
+
+        /** \brief Write a header defining the order as the constexpr array
+         ** \a name, to build the chain without the profile. */
+        void write_order(std::ostream& o, const std::string& name) const;
+
+    private:
+        /// Whether \a node matches \a p.
+        static bool test(const pattern& p, const Node* node);
+
+        /// The patterns, in the order they are tried.
+        std::vector<pattern> patterns_;
+        /// Their indices in the set.
+        std::vector<int> order_;
+    };
+
+} // namespace misc
+
+#include "rule-chain.hxx"
@@ -0,0 +1,208 @@
+/**
+ ** \file misc/rule-chain.hxx
+ ** \brief Implementation of misc::rule_chain.
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+#include "rule-chain.hh"
+
+namespace misc
+{
+    namespace detail
+    {
+        /// Whether some tree matches both \a p and \a q.
+        inline bool overlap(const pattern& p, const pattern& q)
+        {
+            if (p.is_any() || q.is_any())
+                return true;
+            if (p.kind_get() != q.kind_get())
+                return false;
+
+            const auto& ps = p.children_get();
+            const auto& qs = q.children_get();
+            for (std::size_t i = 0; i < std::min(ps.size(), qs.size()); ++i)
+                if (!overlap(ps[i], qs[i]))
+                    return false;
+            return true;
+        }
+
+        /// Which patterns of \a patterns overlap each other.
+        inline std::vector<std::vector<bool>>
+        overlaps(const std::vector<pattern>& patterns)
+        {
+            std::size_t n = patterns.size();
+            std::vector<std::vector<bool>> res(n, std::vector<bool>(n));
+            for (std::size_t i = 0; i < n; ++i)
+                for (std::size_t j = 0; j < n; ++j)
+                    res[i][j] = overlap(patterns[i], patterns[j]);
+            return res;
+        }
+
+        /// The patterns of \a patterns, hottest first according to \a
+        /// profile, each after the earlier patterns it overlaps.
+        ///
+        /// Trying a pattern first means first trying the earlier ones it
+        /// overlaps which are not placed yet, its closure: each step places
+        /// the closure with the most hits per pattern, in the order of the
+        /// set.  This is the greedy ordering of jobs under precedence
+        /// constraints, which places for instance a hot Mem(_) along with a
+        /// cold Mem(Mem(_)) before it.
+        inline std::vector<int> profile_order(
+            const std::vector<pattern>& patterns, const rule_profile& profile)
+        {
+            std::size_t n = patterns.size();
+            if (profile.size() != n)
+                throw std::invalid_argument(
+                    "rule_chain: profile of another set of patterns");
+            auto overlapping = overlaps(patterns);
+
+            std::vector<bool> placed(n);
+            std::vector<int> res;
+            while (res.size() < n)
+            {
+                // Ties keep the order of the set
+                std::vector<bool> best;
+                std::uint64_t best_hits = 0;
+                std::size_t best_size = 1;
+                for (std::size_t r = 0; r < n; ++r)
+                {
+                    if (placed[r])
+                        continue;
+
+                    // Earlier patterns come first: scan them backward
+                    std::vector<bool> closure(n);
+                    closure[r] = true;
+                    std::uint64_t hits = profile.hits_get(r);
+                    std::size_t size = 1;
+                    for (std::size_t q = r; q-- > 0;)
+                        if (!placed[q])
+                            for (std::size_t m = q + 1; m <= r; ++m)
+                                if (closure[m] && overlapping[q][m])
+                                {
+                                    closure[q] = true;
+                                    hits += profile.hits_get(q);
+                                    ++size;
+                                    break;
+                                }
+
+                    if (best.empty() || hits * best_size > best_hits * size)
+                    {
+                        best = std::move(closure);
+                        best_hits = hits;
+                        best_size = size;
+                    }
+                }
+
+                for (std::size_t r = 0; r < n; ++r)
+                    if (best[r])
+                    {
+                        placed[r] = true;
+                        res.push_back(r);
+                    }
+            }
+            return res;
+        }
+
+        /// Throw std::invalid_argument unless trying \a patterns in the
+        /// order \a order matches as trying them in their order.
+        inline void check_order(const std::vector<pattern>& patterns,
+                                const std::vector<int>& order)
+        {
+            std::size_t n = patterns.size();
+            if (order.size() != n)
+                throw std::invalid_argument("rule_chain: not a permutation");
+
+            std::vector<std::size_t> position(n, n);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (order[i] < 0 || std::size_t(order[i]) >= n
+                    || position[order[i]] != n)
+                    throw std::invalid_argument(
+                        "rule_chain: not a permutation");
+                position[order[i]] = i;
+            }
+
+            auto overlapping = overlaps(patterns);
+            for (std::size_t i = 0; i < n; ++i)
+                for (std::size_t j = i + 1; j < n; ++j)
+                    if (overlapping[i][j] && position[j] < position[i])
+                        throw std::invalid_argument(
+                            "rule_chain: pattern tried before an earlier one "
+                            "it overlaps");
+        }
+    } // namespace detail
+
+    template <typename Node>
+    rule_chain<Node>::rule_chain(const std::vector<pattern>& patterns)
+        : patterns_(patterns)
+    {
+        for (std::size_t i = 0; i < patterns.size(); ++i)
+            order_.push_back(i);
+    }
+
+    template <typename Node>
+    rule_chain<Node>::rule_chain(const std::vector<pattern>& patterns,
+                                 const rule_profile& profile)
+        : rule_chain(patterns, detail::profile_order(patterns, profile))
+    {}
+
+    template <typename Node>
+    rule_chain<Node>::rule_chain(const std::vector<pattern>& patterns,
+                                 const std::vector<int>& order)
+        : order_(order)
+    {
+        detail::check_order(patterns, order);
+        for (int i : order)
+            patterns_.push_back(patterns[i]);
+    }
+
+    template <typename Node>
+    bool rule_chain<Node>::test(const pattern& p, const Node* node)
+    {
+        if (p.is_any())
+            return true;
+        if (static_cast<std::size_t>(node->kind_get()) != p.kind_get())
+            return false;
+
+        const auto& children = p.children_get();
+        for (std::size_t i = 0; i < children.size(); ++i)
+            if (!test(children[i], node->child_get(i)))
+                return false;
+        return true;
+    }
+
+    template <typename Node>
+    int rule_chain<Node>::match(const Node& node) const
+    {
+        for (std::size_t i = 0; i < patterns_.size(); ++i)
+            if (test(patterns_[i], &node))
+                return order_[i];
+        return no_match;
+    }
+
+    template <typename Node>
+    const std::vector<int>& rule_chain<Node>::order_get() const
+    {
+        return order_;
+    }
+
+    template <typename Node>
+    void rule_chain<Node>::write_order(std::ostream& o,
+                                       const std::string& name) const
+    {
+        o << "// Generated by misc::rule_chain::write_order.\n"
+          << "#pragma once\n\n"
+          << "inline constexpr int " << name << "[] = {";
+        for (std::size_t i = 0; i < order_.size(); ++i)
+            o << (i ? ", " : "") << order_[i];
+        o << "};\n";
+    }
+
+} // namespace misc
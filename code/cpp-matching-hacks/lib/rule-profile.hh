@@ -0,0 +1,52 @@
+/**
+ ** \file misc/rule-profile.hh
+ ** \brief Declaration of misc::rule_profile.
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace misc
+{
+    /// The number of hits of each rule of a matcher.
+    ///
+    /// Gathered by a profiling run and saved, it is loaded by a later run to
+    /// try the hottest rules first (see misc::rule_chain).  The file is a
+    /// single line: `rule-profile N` followed by the N counts.
+    class rule_profile
+    {
+    public:
+        /** \brief Construct a profile of \a rules rules, never hit. */
+        rule_profile(std::size_t rules = 0);
+
+        /** \brief Count a hit of \a rule, ignored if negative, i.e. if
+         ** nothing matched. */
+        void hit(int rule);
+
+        /// \name Accessors.
+        /// \{
+        std::uint64_t hits_get(std::size_t rule) const;
+        std::size_t size() const;
+        /// \}
+
+        /// \name Persistence.
+        /// \{
+        /** \brief Write the profile to \a o. */
+        void save(std::ostream& o) const;
+
+        /** \brief Read a profile saved to \a i.
+         ** Throw std::runtime_error if it is malformed. */
+        static rule_profile load(std::istream& i);
+        /// \}
+
+    private:
+        std::vector<std::uint64_t> hits_;
+    };
+
+} // namespace misc
+
+#include "rule-profile.hxx"
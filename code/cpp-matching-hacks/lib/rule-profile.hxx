@@ -0,0 +1,59 @@
+/**
+ ** \file misc/rule-profile.hxx
+ ** \brief Implementation of misc::rule_profile.
+ **/
+
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+#include "rule-profile.hh"
+
+namespace misc
+{
+    inline rule_profile::rule_profile(std::size_t rules)
+        : hits_(rules)
+    {}
+
+    inline void rule_profile::hit(int rule)
+    {
+        if (rule >= 0)
+            ++hits_.at(rule);
+    }
+
+    inline std::uint64_t rule_profile::hits_get(std::size_t rule) const
+    {
+        return hits_.at(rule);
+    }
+
+    inline std::size_t rule_profile::size() const
+    {
+        return hits_.size();
+    }
+
+    inline void rule_profile::save(std::ostream& o) const
+    {
+        o << "rule-profile " << hits_.size();
+        for (auto h : hits_)
+            o << ' ' << h;
+        o << '\n';
+    }
+
+    inline rule_profile rule_profile::load(std::istream& i)
+    {
+        std::string magic;
+        std::size_t rules;
+        if (!(i >> magic >> rules) || magic != "rule-profile")
+            throw std::runtime_error("rule_profile: not a profile");
+
+        rule_profile res(rules);
+        for (auto& h : res.hits_)
+            if (!(i >> h))
+                throw std::runtime_error("rule_profile: truncated profile");
+        return res;
+    }
+
+} // namespace misc
@@ -0,0 +1,39 @@
+/**
+ ** \file misc/tag-visit.hh
+ ** \brief Declaration of misc::tag_visit.
+ **/
+
+#pragma once
+
+#include <cstddef>
+
+namespace misc
+{
+    /// The list of concrete types a tagged base may dynamically be.
+    ///
+    /// A base class opts in by declaring an \c alternatives_type member
+    /// type, and a \c kind_get() method returning the index of the dynamic
+    /// type of the node in this list.
+    template <typename... Alts>
+    struct alternatives
+    {
+        static constexpr std::size_t size = sizeof...(Alts);
+    };
+
+    /** \brief Call \a f on \a node, downcast to its dynamic type.
+     **
+     ** The dynamic type is read from the tag stored in \a node, and the
+     ** call goes through a single constexpr table of function pointers,
+     ** one per alternative: no virtual call, no temporary variant and no
+     ** reference count is involved.  Overload resolution is the one \a f
+     ** would get when called on a reference to the concrete type.
+     **
+     ** Alternatives which do not derive from \a Base cannot be reached, a
+     ** node tagged with one of them aborts the program.
+     **/
+    template <typename F, typename Base>
+    decltype(auto) tag_visit(F&& f, Base& node);
+
+} // namespace misc
+
+#include "tag-visit.hxx"
@@ -0,0 +1,76 @@
+/**
+ ** \file misc/tag-visit.hxx
+ ** \brief Implementation of misc::tag_visit.
+ **/
+
+#pragma once
+
+#include <concepts>
+#include <cstdlib>
+#include <tuple>
+#include <type_traits>
+
+#include "tag-visit.hh"
+
+namespace misc
+{
+    namespace detail
+    {
+        /// \a Alt, const-qualified if \a Base is.
+        template <typename Base, typename Alt>
+        using like_t =
+            std::conditional_t<std::is_const_v<Base>, const Alt, Alt>;
+
+        /// Index of the first alternative deriving from \a Base.
+        template <typename Base, typename... Alts>
+        constexpr std::size_t first_derived()
+        {
+            using base_type = std::remove_const_t<Base>;
+            std::size_t res = 0;
+            bool found = false;
+            ((found = found || std::derived_from<Alts, base_type>,
+              res += !found),
+             ...);
+            return res;
+        }
+
+        /// The type returned by a tag visit of \a F on \a Base.
+        template <typename F, typename Base, typename... Alts>
+        using tag_visit_result_t = std::invoke_result_t<
+            F&,
+            like_t<Base,
+                   std::tuple_element_t<first_derived<Base, Alts...>(),
+                                        std::tuple<Alts...>>>&>;
+
+        /// Build the dispatch table and jump through it.
+        template <typename F, typename Base, typename... Alts>
+        decltype(auto) tag_visit(alternatives<Alts...>, F& f, Base& node)
+        {
+            static_assert(first_derived<Base, Alts...>() < sizeof...(Alts),
+                          "no alternative derives from the visited base");
+
+            using result_type = tag_visit_result_t<F, Base, Alts...>;
+            using entry_type = result_type (*)(F&, Base&);
+
+            static constexpr entry_type table[] = {
+                [](F& f, Base& node) -> result_type {
+                    if constexpr (std::derived_from<Alts,
+                                                    std::remove_const_t<Base>>)
+                        return f(static_cast<like_t<Base, Alts>&>(node));
+                    else
+                        std::abort();
+                }...};
+
+            return table[static_cast<std::size_t>(node.kind_get())](f, node);
+        }
+    } // namespace detail
+
+    template <typename F, typename Base>
+    decltype(auto) tag_visit(F&& f, Base& node)
+    {
+        using alternatives_type =
+            typename std::remove_const_t<Base>::alternatives_type;
+        return detail::tag_visit(alternatives_type{}, f, node);
+    }
+
+} // namespace misc
@@ -0,0 +1,61 @@
+/**
+ ** \file misc/tagged-child.hh
+ ** \brief Declaration of misc::tagged_child.
+ **/
+
+#pragma once
+
+#include <cstdint>
+
+namespace misc
+{
+    /// A child slot holding either an immediate leaf inline or a pointer to
+    /// an interior \a Node.
+    ///
+    /// Both share one pointer-sized word, told apart by its low bit: nodes
+    /// are at least 2-byte aligned, so the low bit of their address is
+    /// clear, and immediates are stored shifted left with the bit set.
+    /// Leaves thus need no allocation at all, only interior nodes live on
+    /// the heap or in an arena.  The slot does not own its node.
+    template <typename Node>
+    class tagged_child
+    {
+    public:
+        using imm_type = std::int32_t;
+        using node_type = Node;
+
+        static_assert(sizeof(std::uintptr_t) > sizeof(imm_type),
+                      "immediates must fit in a word beside the tag bit");
+
+        /// \name Constructors.
+        /// \{
+        /** \brief A slot holding the immediate \a imm inline. */
+        tagged_child(imm_type imm);
+
+        /** \brief A slot pointing to \a node, which must not be null. */
+        tagged_child(Node* node);
+        /// \}
+
+        /// \name Accessors.
+        /// \{
+        /** \brief Whether the slot holds an immediate. */
+        bool is_imm() const;
+
+        /** \brief The immediate of the slot, which must hold one. */
+        imm_type imm_get() const;
+
+        /** \brief The node of the slot, which must hold one. */
+        Node* node_get() const;
+        /// \}
+
+        /** \brief Call \a f with the immediate or the node of the slot. */
+        template <typename F>
+        decltype(auto) visit(F&& f) const;
+
+    private:
+        std::uintptr_t bits_;
+    };
+
+} // namespace misc
+
+#include "tagged-child.hxx"
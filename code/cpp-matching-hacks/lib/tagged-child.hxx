@@ -0,0 +1,72 @@
+/**
+ ** \file misc/tagged-child.hxx
+ ** \brief Implementation of misc::tagged_child.
+ **/
+
+#pragma once
+
+#include <cassert>
+#include <utility>
+
+#include "tagged-child.hh"
+
+namespace misc
+{
+    /*---------------.
+    | Constructors.  |
+    `---------------*/
+
+    template <typename Node>
+    tagged_child<Node>::tagged_child(imm_type imm)
+        // Shift the sign-extended unsigned representation: shifting a
+        // negative left is undefined before C++20.
+        : bits_((static_cast<std::uintptr_t>(imm) << 1) | 1)
+    {}
+
+    template <typename Node>
+    tagged_child<Node>::tagged_child(Node* node)
+        : bits_(reinterpret_cast<std::uintptr_t>(node))
+    {
+        static_assert(alignof(Node) >= 2, "the tag bit must be free");
+        assert(node);
+    }
+
+    /*------------.
+    | Accessors.  |
+    `------------*/
+
+    template <typename Node>
+    bool tagged_child<Node>::is_imm() const
+    {
+        return bits_ & 1;
+    }
+
+    template <typename Node>
+    auto tagged_child<Node>::imm_get() const -> imm_type
+    {
+        assert(is_imm());
+        // Arithmetic shift, which restores the sign since C++20.
+        return static_cast<imm_type>(static_cast<std::intptr_t>(bits_) >> 1);
+    }
+
+    template <typename Node>
+    Node* tagged_child<Node>::node_get() const
+    {
+        assert(!is_imm());
+        return reinterpret_cast<Node*>(bits_);
+    }
+
+    /*-----------.
+    | Visiting.  |
+    `-----------*/
+
+    template <typename Node>
+    template <typename F>
+    decltype(auto) tagged_child<Node>::visit(F&& f) const
+    {
+        if (is_imm())
+            return std::forward<F>(f)(imm_get());
+        return std::forward<F>(f)(node_get());
+    }
+
+} // namespace misc
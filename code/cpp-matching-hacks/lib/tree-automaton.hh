@@ -0,0 +1,88 @@
+/**
+ ** \file misc/tree-automaton.hh
+ ** \brief Declaration of misc::tree_automaton.
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "match-memo.hh"
+
+namespace misc
+{
+    /// Pattern matching a node of kind \a Kind whose children match \a
+    /// Children..., such as `op<MOVE, op<MEM, wild>, op<INT>>`.
+    template <std::size_t Kind, typename... Children>
+    struct op
+    {};
+
+    /// Pattern matching any node.
+    struct wild
+    {};
+
+    /// A bottom-up tree automaton matching a static set of patterns.
+    ///
+    /// As burg and iburg do offline, the states of the automaton and its
+    /// transition tables are computed at compile time from \a Rules: a state
+    /// is the set of sub-patterns matching a node.  At run time, the state of
+    /// a node is a single table lookup indexed by its kind and the states of
+    /// its children, and the matched rule is a lookup in the state.
+    ///
+    /// Nodes have at most two children, and there are at most 64 distinct
+    /// sub-patterns and 255 states.  The first matching rule wins.
+    ///
+    /// \a Node must provide \c kind_get(), \c child_count() and \c
+    /// child_get(i), the latter returning a pointer to the \a i th child.
+    /// Flat forests such as misc::flat_tree are matched by \c match_flat().
+    template <std::size_t KindCount, typename... Rules>
+    class tree_automaton
+    {
+    public:
+        using state_type = std::uint8_t;
+
+        /// Rule index returned when no rule matches.
+        static constexpr int no_match = -1;
+
+        /// Number of states of the automaton.
+        static constexpr std::size_t state_count();
+
+        /** \brief The state of a node of kind \a kind, whose children are
+         ** in states \a left and \a right. */
+        static state_type state(std::size_t kind, state_type left = 0,
+                                state_type right = 0);
+
+        /** \brief The rule matched by a node in state \a s, or \c no_match. */
+        static int rule(state_type s);
+
+        /** \brief Return the rule matched by \a node. */
+        template <typename Node>
+        static int match(const Node& node);
+
+        /** \brief Match every node under \a root, bottom-up, calling \a f
+         ** with each node and its rule.  Return the state of \a root. */
+        template <typename Node, typename F>
+        static state_type match_all(const Node& root, F&& f);
+
+        /** \brief Same as above, but nodes whose state is in the table of
+         ** \a pass are not matched again: each node of a DAG is matched and
+         ** passed to \a f once per pass. */
+        template <typename Node, typename F>
+        static state_type
+        match_all(const Node& root,
+                  const typename match_memo<state_type>::pass& pass, F&& f);
+
+        /** \brief Match every node of the flat forest \a tree in a single
+         ** forward scan, calling \a f with each node index and its rule.
+         ** Nodes must be stored in post-order, \a states receives the
+         ** state of every node. */
+        template <typename FlatTree, typename F>
+        static void match_flat(const FlatTree& tree,
+                               std::vector<state_type>& states, F&& f);
+    };
+
+} // namespace misc
+
+#include "tree-automaton.hxx"
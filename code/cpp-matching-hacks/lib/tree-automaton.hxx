@@ -0,0 +1,312 @@
+/**
+ ** \file misc/tree-automaton.hxx
+ ** \brief Implementation of misc::tree_automaton.
+ **/
+
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <stdexcept>
+
+#include "tree-automaton.hh"
+
+namespace misc
+{
+    namespace detail
+    {
+        /// Kind of the wildcard sub-pattern.
+        inline constexpr std::size_t wild_kind = -1;
+
+        /// Maximum number of distinct sub-patterns, one bit each in a state.
+        inline constexpr std::size_t max_subpatterns = 64;
+
+        /// Maximum number of states.
+        inline constexpr std::size_t max_states = 255;
+
+        /// A sub-pattern, its children are indices of other sub-patterns.
+        struct subpattern
+        {
+            std::size_t kind;
+            std::size_t arity;
+            std::size_t children[2];
+        };
+
+        /// The sub-patterns of a rule set, shared when structurally equal.
+        /// The first one is the wildcard.
+        struct pattern_set
+        {
+            subpattern subs[max_subpatterns] = {{wild_kind, 0, {0, 0}}};
+            std::size_t size = 1;
+
+            constexpr std::size_t add(std::size_t kind, std::size_t arity,
+                                      std::size_t left, std::size_t right)
+            {
+                for (std::size_t i = 0; i < size; ++i)
+                    if (subs[i].kind == kind && subs[i].arity == arity
+                        && subs[i].children[0] == left
+                        && subs[i].children[1] == right)
+                        return i;
+
+                if (size == max_subpatterns)
+                    throw std::length_error("tree_automaton: too many "
+                                            "sub-patterns");
+                subs[size] = {kind, arity, {left, right}};
+                return size++;
+            }
+        };
+
+        /// Add the pattern \a P to a pattern set.
+        template <typename P>
+        struct pattern_adder;
+
+        template <>
+        struct pattern_adder<wild>
+        {
+            static constexpr std::size_t add(pattern_set&)
+            {
+                return 0;
+            }
+        };
+
+        template <std::size_t Kind, typename... Children>
+        struct pattern_adder<op<Kind, Children...>>
+        {
+            static_assert(sizeof...(Children) <= 2,
+                          "tree_automaton: nodes have at most two children");
+
+            static constexpr std::size_t add(pattern_set& set)
+            {
+                std::size_t ids[2] = {0, 0};
+                std::size_t i = 0;
+                ((ids[i++] = pattern_adder<Children>::add(set)), ...);
+                return set.add(Kind, sizeof...(Children), ids[0], ids[1]);
+            }
+        };
+
+        /// The tables of an automaton, all computed at compile time.
+        template <std::size_t KindCount, typename... Rules>
+        struct automaton_tables
+        {
+            /// The sub-patterns, and the root sub-pattern of each rule.
+            struct patterns_type
+            {
+                pattern_set set;
+                std::size_t roots[sizeof...(Rules) + 1];
+                std::size_t arities[KindCount];
+            };
+
+            static constexpr patterns_type patterns = [] {
+                patterns_type res{};
+                std::size_t r = 0;
+                ((res.roots[r++] = pattern_adder<Rules>::add(res.set)), ...);
+
+                for (auto& arity : res.arities)
+                    arity = wild_kind;
+                for (std::size_t i = 1; i < res.set.size; ++i)
+                {
+                    const auto& sub = res.set.subs[i];
+                    if (sub.kind >= KindCount)
+                        throw std::invalid_argument("tree_automaton: "
+                                                    "unknown kind");
+                    if (res.arities[sub.kind] != wild_kind
+                        && res.arities[sub.kind] != sub.arity)
+                        throw std::invalid_argument("tree_automaton: kind "
+                                                    "used with different "
+                                                    "arities");
+                    res.arities[sub.kind] = sub.arity;
+                }
+                return res;
+            }();
+
+            /// The set of sub-patterns matching a node of kind \a kind whose
+            /// children are matched by \a left and \a right.
+            static constexpr std::uint64_t transition(std::size_t kind,
+                                                      std::uint64_t left,
+                                                      std::uint64_t right)
+            {
+                std::uint64_t res = 1;
+                const auto& set = patterns.set;
+                for (std::size_t i = 1; i < set.size; ++i)
+                {
+                    const auto& sub = set.subs[i];
+                    if (sub.kind == kind
+                        && (sub.arity < 1 || (left >> sub.children[0] & 1))
+                        && (sub.arity < 2 || (right >> sub.children[1] & 1)))
+                        res |= std::uint64_t(1) << i;
+                }
+                return res;
+            }
+
+            /// The reachable states, as sets of sub-patterns.
+            struct states_type
+            {
+                std::uint64_t masks[max_states] = {1};
+                std::size_t size = 1;
+
+                constexpr std::size_t find(std::uint64_t mask) const
+                {
+                    for (std::size_t i = 0; i < size; ++i)
+                        if (masks[i] == mask)
+                            return i;
+                    return size;
+                }
+            };
+
+            static constexpr states_type states = [] {
+                states_type res;
+                for (bool changed = true; changed;)
+                {
+                    changed = false;
+                    for (std::size_t kind = 0; kind < KindCount; ++kind)
+                    {
+                        std::size_t arity = patterns.arities[kind];
+                        if (arity == wild_kind)
+                            continue;
+
+                        std::size_t lefts = arity >= 1 ? res.size : 1;
+                        std::size_t rights = arity >= 2 ? res.size : 1;
+                        for (std::size_t l = 0; l < lefts; ++l)
+                            for (std::size_t r = 0; r < rights; ++r)
+                            {
+                                auto mask = transition(kind, res.masks[l],
+                                                       res.masks[r]);
+                                if (res.find(mask) < res.size)
+                                    continue;
+                                if (res.size == max_states)
+                                    throw std::length_error(
+                                        "tree_automaton: too many states");
+                                res.masks[res.size++] = mask;
+                                changed = true;
+                            }
+                    }
+                }
+                return res;
+            }();
+
+            static constexpr std::size_t state_count = states.size;
+
+            /// Transitions, indexed by kind, left state and right state.
+            static constexpr auto transitions = [] {
+                std::array<std::uint8_t, KindCount * state_count * state_count>
+                    res{};
+                for (std::size_t kind = 0; kind < KindCount; ++kind)
+                    for (std::size_t l = 0; l < state_count; ++l)
+                        for (std::size_t r = 0; r < state_count; ++r)
+                        {
+                            auto mask = transition(kind, states.masks[l],
+                                                   states.masks[r]);
+                            res[(kind * state_count + l) * state_count + r] =
+                                states.find(mask);
+                        }
+                return res;
+            }();
+
+            /// The first rule matched in each state.
+            static constexpr auto rules = [] {
+                std::array<int, state_count> res{};
+                for (std::size_t s = 0; s < state_count; ++s)
+                {
+                    res[s] = -1;
+                    for (std::size_t r = sizeof...(Rules); r-- > 0;)
+                        if (states.masks[s] >> patterns.roots[r] & 1)
+                            res[s] = r;
+                }
+                return res;
+            }();
+        };
+    } // namespace detail
+
+    template <std::size_t KindCount, typename... Rules>
+    constexpr std::size_t tree_automaton<KindCount, Rules...>::state_count()
+    {
+        return detail::automaton_tables<KindCount, Rules...>::state_count;
+    }
+
+    template <std::size_t KindCount, typename... Rules>
+    auto tree_automaton<KindCount, Rules...>::state(std::size_t kind,
+                                                    state_type left,
+                                                    state_type right)
+        -> state_type
+    {
+        using tables = detail::automaton_tables<KindCount, Rules...>;
+        constexpr std::size_t n = tables::state_count;
+        return tables::transitions[(kind * n + left) * n + right];
+    }
+
+    template <std::size_t KindCount, typename... Rules>
+    int tree_automaton<KindCount, Rules...>::rule(state_type s)
+    {
+        return detail::automaton_tables<KindCount, Rules...>::rules[s];
+    }
+
+    template <std::size_t KindCount, typename... Rules>
+    template <typename Node>
+    int tree_automaton<KindCount, Rules...>::match(const Node& node)
+    {
+        return rule(match_all(node, [](const Node&, int) {}));
+    }
+
+    template <std::size_t KindCount, typename... Rules>
+    template <typename Node, typename F>
+    auto tree_automaton<KindCount, Rules...>::match_all(const Node& root,
+                                                        F&& f) -> state_type
+    {
+        state_type children[2] = {0, 0};
+        std::size_t arity = root.child_count();
+        assert(arity <= 2);
+        for (std::size_t i = 0; i < arity; ++i)
+            children[i] = match_all(*root.child_get(i), f);
+
+        state_type res = state(static_cast<std::size_t>(root.kind_get()),
+                               children[0], children[1]);
+        f(root, rule(res));
+        return res;
+    }
+
+    template <std::size_t KindCount, typename... Rules>
+    template <typename Node, typename F>
+    auto tree_automaton<KindCount, Rules...>::match_all(
+        const Node& root, const typename match_memo<state_type>::pass& pass,
+        F&& f) -> state_type
+    {
+        match_memo<state_type>& memo = pass.memo_get();
+        if (const state_type* res = memo.find(&root))
+            return *res;
+
+        state_type children[2] = {0, 0};
+        std::size_t arity = root.child_count();
+        assert(arity <= 2);
+        for (std::size_t i = 0; i < arity; ++i)
+            children[i] = match_all(*root.child_get(i), pass, f);
+
+        state_type res = state(static_cast<std::size_t>(root.kind_get()),
+                               children[0], children[1]);
+        memo.insert(&root, res);
+        f(root, rule(res));
+        return res;
+    }
+
+    template <std::size_t KindCount, typename... Rules>
+    template <typename FlatTree, typename F>
+    void tree_automaton<KindCount, Rules...>::match_flat(
+        const FlatTree& tree, std::vector<state_type>& states, F&& f)
+    {
+        using index_type = typename FlatTree::index_type;
+
+        states.resize(tree.size());
+        for (index_type i = 0; i < tree.size(); ++i)
+        {
+            state_type children[2] = {0, 0};
+            std::size_t arity = tree.child_count(i);
+            assert(arity <= 2);
+            for (std::size_t c = 0; c < arity; ++c)
+                children[c] = states[tree.child_get(i, c)];
+
+            states[i] = state(static_cast<std::size_t>(tree.kind_get(i)),
+                              children[0], children[1]);
+            f(i, rule(states[i]));
+        }
+    }
+
+} // namespace misc
@@ -0,0 +1,123 @@
+/**
+ ** \file misc/tree-stream.hh
+ ** \brief Declaration of misc::tree_writer and misc::tree_reader.
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+#include "flat-tree.hh"
+
+namespace misc
+{
+    /// Writer of the binary prefix-order tree format.
+    ///
+    /// A stream is a sequence of statements, a statement is one tree, and a
+    /// tree is written in prefix order: a node is a tag byte, its kind
+    /// shifted left by two and its arity, followed for leaves by their
+    /// immediate as a zigzag LEB128 varint, then by its children.  Thus
+    /// kinds are below 64, arities below 4, and a leaf with a small
+    /// immediate takes two bytes.
+    class tree_writer
+    {
+    public:
+        using kind_type = std::uint8_t;
+        using imm_type = std::int32_t;
+
+        explicit tree_writer(std::ostream& out);
+
+        /** \brief Write a leaf of kind \a kind holding \a imm.
+         ** Throw std::invalid_argument unless \a kind is in [0, 63]. */
+        void leaf(kind_type kind, imm_type imm);
+
+        /** \brief Write a node of kind \a kind, whose \a arity children
+         ** must be written next.  Leaves are written with leaf().
+         ** Throw std::invalid_argument unless \a kind is in [0, 63] and \a
+         ** arity in [1, 3]. */
+        void node(kind_type kind, std::size_t arity);
+
+    private:
+        /// Write the tag byte of a node.
+        void tag(kind_type kind, std::size_t arity);
+
+        std::streambuf* out_;
+    };
+
+    /// Streaming reader of the format of misc::tree_writer.
+    ///
+    /// Nodes are built bottom-up as soon as their children are read, by a
+    /// builder \a b providing:
+    /// - \c b.leaf(kind, imm), returning the handle of a new leaf;
+    /// - \c b.node(kind, children, arity), returning the handle of a new
+    ///   node, \a children pointing to the handles of its children.
+    ///
+    /// No intermediate object is created: a builder adds the nodes straight
+    /// to an arena or a misc::flat_tree, and statements may be matched, then
+    /// dropped, one at a time as they arrive.  Handles are of type \a H, and
+    /// the stacks of pending nodes and handles are reused from one
+    /// statement to the next.
+    template <typename H>
+    class tree_reader
+    {
+    public:
+        using kind_type = tree_writer::kind_type;
+        using imm_type = tree_writer::imm_type;
+
+        explicit tree_reader(std::istream& in);
+
+        /** \brief Read the next statement and return the handle of its
+         ** root, or nothing at the end of the stream.
+         **
+         ** Throw std::runtime_error if the stream is truncated. */
+        template <typename B>
+        std::optional<H> read(B&& b);
+
+        /** \brief Read every remaining statement, calling \a f with the
+         ** handle of each root as soon as it is built.  Return the number of
+         ** statements. */
+        template <typename B, typename F>
+        std::size_t for_each(B&& b, F&& f);
+
+    private:
+        /// Next byte of a statement, which must not be over.
+        std::uint8_t next();
+        imm_type read_imm();
+
+        /// A node whose children are being read.
+        struct pending
+        {
+            kind_type kind;
+            std::size_t arity;
+            std::size_t base;
+        };
+
+        std::streambuf* in_;
+        std::vector<pending> pending_;
+        std::vector<H> handles_;
+    };
+
+    /// A builder adding nodes to a misc::flat_tree, in post-order.
+    class flat_builder
+    {
+    public:
+        using index_type = flat_tree::index_type;
+
+        explicit flat_builder(flat_tree& tree);
+
+        index_type leaf(flat_tree::kind_type kind, flat_tree::imm_type imm);
+        index_type node(flat_tree::kind_type kind, const index_type* children,
+                        std::size_t arity);
+
+    private:
+        flat_tree& tree_;
+    };
+
+} // namespace misc
+
+#include "tree-stream.hxx"
@@ -0,0 +1,157 @@
+/**
+ ** \file misc/tree-stream.hxx
+ ** \brief Implementation of misc::tree_writer and misc::tree_reader.
+ **/
+
+#pragma once
+
+#include <cassert>
+#include <stdexcept>
+
+#include "tree-stream.hh"
+
+namespace misc
+{
+    /*--------------.
+    | tree_writer.  |
+    `--------------*/
+
+    inline tree_writer::tree_writer(std::ostream& out)
+        : out_(out.rdbuf())
+    {}
+
+    inline void tree_writer::leaf(kind_type kind, imm_type imm)
+    {
+        tag(kind, 0);
+        // Zigzag: small negative immediates are small varints too.
+        auto u = static_cast<std::uint32_t>(imm);
+        u = (u << 1) ^ (imm < 0 ? ~std::uint32_t(0) : 0);
+        for (; u >= 0x80; u >>= 7)
+            out_->sputc(static_cast<char>(u | 0x80));
+        out_->sputc(static_cast<char>(u));
+    }
+
+    inline void tree_writer::node(kind_type kind, std::size_t arity)
+    {
+        // A null arity would be read as a leaf, followed by an immediate
+        if (arity == 0 || arity > 3)
+            throw std::invalid_argument("tree_writer: arity out of [1, 3]");
+        tag(kind, arity);
+    }
+
+    inline void tree_writer::tag(kind_type kind, std::size_t arity)
+    {
+        if (kind >= 64)
+            throw std::invalid_argument("tree_writer: kind out of [0, 63]");
+        out_->sputc(static_cast<char>((kind << 2) | arity));
+    }
+
+    /*--------------.
+    | tree_reader.  |
+    `--------------*/
+
+    template <typename H>
+    tree_reader<H>::tree_reader(std::istream& in)
+        : in_(in.rdbuf())
+    {}
+
+    template <typename H>
+    std::uint8_t tree_reader<H>::next()
+    {
+        auto c = in_->sbumpc();
+        if (c == std::streambuf::traits_type::eof())
+            throw std::runtime_error("tree_reader: truncated stream");
+        return static_cast<std::uint8_t>(c);
+    }
+
+    template <typename H>
+    auto tree_reader<H>::read_imm() -> imm_type
+    {
+        std::uint32_t u = 0;
+        for (int shift = 0;; shift += 7)
+        {
+            if (shift > 28)
+                throw std::runtime_error("tree_reader: immediate too long");
+            std::uint8_t c = next();
+            u |= static_cast<std::uint32_t>(c & 0x7f) << shift;
+            if (!(c & 0x80))
+                break;
+        }
+        return static_cast<imm_type>((u >> 1) ^ (~(u & 1) + 1));
+    }
+
+    template <typename H>
+    template <typename B>
+    std::optional<H> tree_reader<H>::read(B&& b)
+    {
+        auto c = in_->sbumpc();
+        if (c == std::streambuf::traits_type::eof())
+            return std::nullopt;
+
+        // Left over if the builder threw during the previous statement.
+        pending_.clear();
+        handles_.clear();
+
+        for (auto tag = static_cast<std::uint8_t>(c);; tag = next())
+        {
+            kind_type kind = tag >> 2;
+            std::size_t arity = tag & 3;
+            if (arity)
+            {
+                pending_.push_back({kind, arity, handles_.size()});
+                continue;
+            }
+
+            // A leaf completes its parent if it is its last child, which
+            // may complete the grandparent, and so on.
+            handles_.push_back(b.leaf(kind, read_imm()));
+            while (!pending_.empty())
+            {
+                const pending& p = pending_.back();
+                if (handles_.size() - p.base < p.arity)
+                    break;
+                H res = b.node(p.kind, handles_.data() + p.base, p.arity);
+                handles_.erase(handles_.begin() + p.base, handles_.end());
+                handles_.push_back(res);
+                pending_.pop_back();
+            }
+            if (pending_.empty())
+            {
+                assert(handles_.size() == 1);
+                return handles_.back();
+            }
+        }
+    }
+
+    template <typename H>
+    template <typename B, typename F>
+    std::size_t tree_reader<H>::for_each(B&& b, F&& f)
+    {
+        std::size_t res = 0;
+        for (; auto root = read(b); ++res)
+            f(*root);
+        return res;
+    }
+
+    /*---------------.
+    | flat_builder.  |
+    `---------------*/
+
+    inline flat_builder::flat_builder(flat_tree& tree)
+        : tree_(tree)
+    {}
+
+    inline auto flat_builder::leaf(flat_tree::kind_type kind,
+                                   flat_tree::imm_type imm) -> index_type
+    {
+        return tree_.add_leaf(kind, imm);
+    }
+
+    inline auto flat_builder::node(flat_tree::kind_type kind,
+                                   const index_type* children,
+                                   std::size_t arity) -> index_type
+    {
+        return tree_.add_node(kind, children, arity);
+    }
+
+} // namespace misc
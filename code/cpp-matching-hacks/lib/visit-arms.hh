@@ -0,0 +1,53 @@
+/**
+ ** \file misc/visit-arms.hh
+ ** \brief Declaration of misc::visit_arms.
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+
+namespace misc
+{
+    /// Wildcard pattern: the arm receives the whole variant at this
+    /// position instead of one of its alternatives.
+    struct any
+    {};
+
+    /// A visitor arm: a callable \a F and the pattern it matches, one type
+    /// per visited variant, either an alternative of the variant or \c any.
+    template <typename F, typename... Ps>
+    struct arm_t
+    {
+        static constexpr std::size_t arity = sizeof...(Ps);
+
+        F f;
+    };
+
+    /** \brief Build an arm matching \a Ps... and running \a f.
+     **
+     ** \a f is called with the alternatives named in the pattern, and with
+     ** the variants themselves where the pattern is \c any.  Thus, an arm is
+     ** instantiated exactly once, whatever the number of combinations of
+     ** alternatives it covers.
+     **/
+    template <typename... Ps, typename F>
+    arm_t<F, Ps...> arm(F f);
+
+    /** \brief Visit \a vs... with the first arm of \a arms whose pattern
+     ** matches their alternatives, like an OCaml match.
+     **
+     ** Unlike std::visit, which instantiates the visitor for every element of
+     ** the Cartesian product of the alternatives, the generated code only
+     ** grows with the number of arms: the arm to call for each combination
+     ** is computed at compile time in a table of indices.  A combination
+     ** covered by no arm is a compile-time error.  Throw
+     ** std::bad_variant_access if one of \a vs... is valueless.
+     **/
+    template <typename... Arms, typename... Vs>
+    decltype(auto) visit_arms(const std::tuple<Arms...>& arms, Vs&&... vs);
+
+} // namespace misc
+
+#include "visit-arms.hxx"
@@ -0,0 +1,171 @@
+/**
+ ** \file misc/visit-arms.hxx
+ ** \brief Implementation of misc::visit_arms.
+ **/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "combination.hh"
+#include "visit-arms.hh"
+
+namespace misc
+{
+    template <typename... Ps, typename F>
+    arm_t<F, Ps...> arm(F f)
+    {
+        return {std::move(f)};
+    }
+
+    namespace detail
+    {
+        /// Index of a wildcard in a pattern.
+        inline constexpr std::size_t npos = -1;
+
+        /// Index of \a P in the alternatives of \a V.
+        template <typename P, typename V, std::size_t... I>
+        constexpr std::size_t index_of(std::index_sequence<I...>)
+        {
+            std::size_t res = npos;
+            ((res = std::is_same_v<P, std::variant_alternative_t<I, V>> ? I
+                                                                         : res),
+             ...);
+            return res;
+        }
+
+        /// Index matched by the pattern \a P in the variant \a V.
+        template <typename P, typename V>
+        constexpr std::size_t pattern_index()
+        {
+            if constexpr (std::is_same_v<P, any>)
+                return npos;
+            else
+            {
+                constexpr std::size_t res = index_of<P, V>(
+                    std::make_index_sequence<std::variant_size_v<V>>());
+                static_assert(res != npos,
+                              "pattern is not an alternative of the variant");
+                return res;
+            }
+        }
+
+        /// The pattern of an arm, as alternative indices.
+        template <typename Arm, typename... Vs>
+        struct arm_pattern;
+
+        template <typename F, typename... Ps, typename... Vs>
+        struct arm_pattern<arm_t<F, Ps...>, Vs...>
+        {
+            static_assert(sizeof...(Ps) == sizeof...(Vs),
+                          "arm pattern and visited variants differ in size");
+
+            static constexpr std::array<std::size_t, sizeof...(Vs)> value = {
+                pattern_index<Ps, Vs>()...};
+        };
+
+        /// The arm to call for each combination of alternatives, indexed in
+        /// row-major order.
+        template <typename Arms, typename Vs>
+        struct arm_table;
+
+        template <typename... Arms, typename... Vs>
+        struct arm_table<std::tuple<Arms...>, std::tuple<Vs...>>
+        {
+            static constexpr std::size_t arms = sizeof...(Arms);
+            static constexpr std::size_t variants = sizeof...(Vs);
+            static constexpr std::size_t combinations =
+                combination_count<Vs...>;
+
+            using index_type =
+                std::conditional_t<(arms < 256), std::uint8_t, std::uint16_t>;
+
+            static constexpr auto value = [] {
+                constexpr std::array<std::array<std::size_t, variants>, arms>
+                    patterns = {arm_pattern<Arms, Vs...>::value...};
+
+                std::array<index_type, combinations> res{};
+                for (std::size_t c = 0; c < combinations; ++c)
+                {
+                    auto alts = combination_alternatives<Vs...>(c);
+
+                    std::size_t a = 0;
+                    for (; a < arms; ++a)
+                    {
+                        bool match = true;
+                        for (std::size_t i = 0; i < variants; ++i)
+                            match = match
+                                && (patterns[a][i] == npos
+                                    || patterns[a][i] == alts[i]);
+                        if (match)
+                            break;
+                    }
+                    res[c] = a;
+                }
+                return res;
+            }();
+
+            static constexpr bool exhaustive = [] {
+                for (auto a : value)
+                    if (a == arms)
+                        return false;
+                return true;
+            }();
+        };
+
+        /// Give an arm the alternative it expects, or the whole variant.
+        template <typename P, typename V>
+        decltype(auto) project(V& v)
+        {
+            if constexpr (std::is_same_v<P, any>)
+                return (v);
+            else
+                return *std::get_if<P>(&v);
+        }
+
+        template <typename F, typename... Ps, typename... Vs>
+        decltype(auto) call_arm(const arm_t<F, Ps...>& arm, Vs&... vs)
+        {
+            return arm.f(project<Ps>(vs)...);
+        }
+
+        /// Entry of the arm jump table.
+        template <std::size_t A, typename Arms, typename... Vs>
+        decltype(auto) call_arm(const Arms& arms, Vs&... vs)
+        {
+            return call_arm(std::get<A>(arms), vs...);
+        }
+
+        template <typename Arms, typename... Vs, std::size_t... A>
+        decltype(auto) visit_arms(const Arms& arms, std::index_sequence<A...>,
+                                  Vs&... vs)
+        {
+            using table =
+                arm_table<Arms, std::tuple<std::remove_const_t<Vs>...>>;
+            static_assert(table::exhaustive, "non-exhaustive arms");
+
+            using result_type = decltype(call_arm<0>(arms, vs...));
+            using entry_type = result_type (*)(const Arms&, Vs&...);
+
+            static constexpr entry_type calls[] = {
+                &call_arm<A, Arms, Vs...>...};
+
+            if ((vs.valueless_by_exception() || ...))
+                throw std::bad_variant_access();
+            return calls[table::value[combination_index(vs...)]](arms,
+                                                                 vs...);
+        }
+    } // namespace detail
+
+    template <typename... Arms, typename... Vs>
+    decltype(auto) visit_arms(const std::tuple<Arms...>& arms, Vs&&... vs)
+    {
+        return detail::visit_arms(arms,
+                                  std::index_sequence_for<Arms...>(), vs...);
+    }
+
+} // namespace misc
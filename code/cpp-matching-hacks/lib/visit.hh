@@ -0,0 +1,52 @@
+/**
+ ** \file misc/visit.hh
+ ** \brief Declaration of misc::visit and misc::whole.
+ **/
+
+#pragma once
+
+#include <cstddef>
+
+namespace misc
+{
+    /// A visited variant passed whole to a visitor, for parameters matching
+    /// any of its alternatives.
+    ///
+    /// An overload taking a misc::whole<V> does not care which alternative
+    /// \a V holds: misc::visit calls it through a single function shared by
+    /// every alternative, instead of one function per alternative.
+    template <typename V>
+    class whole
+    {
+    public:
+        explicit whole(const V& v);
+
+        /** \brief The variant itself. */
+        const V& get() const;
+        const V* operator->() const;
+
+    private:
+        const V* v_;
+    };
+
+    /** \brief Call \a f with the alternatives held by \a vs..., like
+     ** std::visit.
+     **
+     ** The alternative indices are combined in a single row-major index,
+     ** \c i0 * K1 * K2 + i1 * K2 + i2 for three variants, which selects the
+     ** function to call in one flat table: one indirect call, whatever the
+     ** number of variants.
+     **
+     ** Alternatives are passed as lvalues.  For every combination, \a f is
+     ** called with the alternatives if it can be.  Otherwise the fewest
+     ** possible variants, leftmost first, are passed as misc::whole: the
+     ** combinations which only differ by these are the same call, and share
+     ** one entry of the table.  Thus a catch-all overload taking misc::whole
+     ** is a single function, not one per combination it covers.
+     **/
+    template <typename F, typename... Vs>
+    decltype(auto) visit(F&& f, Vs&&... vs);
+
+} // namespace misc
+
+#include "visit.hxx"
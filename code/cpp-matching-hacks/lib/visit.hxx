@@ -0,0 +1,223 @@
+/**
+ ** \file misc/visit.hxx
+ ** \brief Implementation of misc::visit and misc::whole.
+ **/
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "combination.hh"
+#include "visit.hh"
+
+namespace misc
+{
+    /*--------.
+    | whole.  |
+    `--------*/
+
+    template <typename V>
+    whole<V>::whole(const V& v)
+        : v_(&v)
+    {}
+
+    template <typename V>
+    const V& whole<V>::get() const
+    {
+        return *v_;
+    }
+
+    template <typename V>
+    const V* whole<V>::operator->() const
+    {
+        return v_;
+    }
+
+    /*--------.
+    | visit.  |
+    `--------*/
+
+    namespace detail
+    {
+        /// Variants passed whole, one bit per variant.
+        using visit_mask_type = unsigned;
+
+        /// Every mask of \a N variants, fewest variants passed whole first.
+        template <std::size_t N>
+        inline constexpr auto visit_masks = [] {
+            std::array<visit_mask_type, (std::size_t(1) << N)> res{};
+            std::size_t k = 0;
+            for (int n = 0; n <= int(N); ++n)
+                for (visit_mask_type m = 0; m < res.size(); ++m)
+                    if (std::popcount(m) == n)
+                        res[k++] = m;
+            return res;
+        }();
+
+        /// What a visitor is given for \a v: the alternative \a I, or
+        /// misc::whole.
+        template <bool Whole, std::size_t I, typename V>
+        decltype(auto) visit_arg(V& v)
+        {
+            if constexpr (Whole)
+                return whole<std::remove_const_t<V>>(v);
+            else
+            {
+                // The index was checked by the jump: do not check it again.
+                auto* res = std::get_if<I>(&v);
+                if (!res)
+                    __builtin_unreachable();
+                return *res;
+            }
+        }
+
+        template <bool Whole, std::size_t I, typename V>
+        using visit_arg_t =
+            decltype(visit_arg<Whole, I>(std::declval<V&>()));
+
+        /// Whether \a F can be called for the combination \a C, the
+        /// variants of \a M passed whole.
+        template <typename F, std::size_t C, visit_mask_type M,
+                  typename... Vs, std::size_t... J>
+        constexpr bool visit_invocable(std::index_sequence<J...>)
+        {
+            constexpr auto alts =
+                combination_alternatives<std::remove_const_t<Vs>...>(C);
+            return std::is_invocable_v<
+                F&, visit_arg_t<bool((M >> J) & 1), alts[J], Vs>...>;
+        }
+
+        /// The first mask from the \a K-th with which \a F can be called for
+        /// the combination \a C.
+        template <typename F, std::size_t C, std::size_t K, typename... Vs>
+        constexpr visit_mask_type visit_mask()
+        {
+            constexpr auto& masks = visit_masks<sizeof...(Vs)>;
+            if constexpr (K == masks.size())
+                return -1;
+            else if constexpr (visit_invocable<F, C, masks[K], Vs...>(
+                                   std::index_sequence_for<Vs...>()))
+                return masks[K];
+            else
+                return visit_mask<F, C, K + 1, Vs...>();
+        }
+
+        /// A function of the table: the variants of \a mask passed whole,
+        /// the alternatives \a alts of the others.
+        template <std::size_t N>
+        struct visit_entry
+        {
+            visit_mask_type mask;
+            std::array<std::size_t, N> alts;
+
+            constexpr bool operator==(const visit_entry&) const = default;
+        };
+
+        template <std::size_t N, std::size_t Combinations>
+        struct visit_layout
+        {
+            using index_type = std::conditional_t<(Combinations <= 256),
+                                                  std::uint8_t, std::uint16_t>;
+
+            /// The distinct entries, in the order of their first use.
+            std::array<visit_entry<N>, Combinations> entries;
+            std::size_t count;
+            /// The entry of each combination.
+            std::array<index_type, Combinations> table;
+            bool callable;
+        };
+
+        /// Each combination is given the entry of its mask, with the
+        /// alternatives of the variants passed whole zeroed.  Combinations
+        /// which differ only by the latter thus share their entry.
+        template <typename F, typename... Vs, std::size_t... C>
+        constexpr auto visit_make_layout(std::index_sequence<C...>)
+        {
+            constexpr std::size_t n = sizeof...(Vs);
+            constexpr std::array<visit_mask_type, sizeof...(C)> masks = {
+                visit_mask<F, C, 0, Vs...>()...};
+
+            visit_layout<n, sizeof...(C)> res{};
+            res.callable = true;
+            for (std::size_t c = 0; c < sizeof...(C); ++c)
+            {
+                if (masks[c] == visit_mask_type(-1))
+                {
+                    res.callable = false;
+                    continue;
+                }
+                visit_entry<n> e{
+                    masks[c],
+                    combination_alternatives<std::remove_const_t<Vs>...>(c)};
+                for (std::size_t i = 0; i < n; ++i)
+                    if ((e.mask >> i) & 1)
+                        e.alts[i] = 0;
+
+                std::size_t k = 0;
+                while (k < res.count && !(res.entries[k] == e))
+                    ++k;
+                if (k == res.count)
+                    res.entries[res.count++] = e;
+                res.table[c] = k;
+            }
+            return res;
+        }
+
+        template <typename F, typename... Vs>
+        inline constexpr auto visit_layout_v =
+            visit_make_layout<F, Vs...>(std::make_index_sequence<
+                combination_count<std::remove_const_t<Vs>...>>());
+
+        template <typename F, std::size_t E, typename... Vs,
+                  std::size_t... J>
+        decltype(auto) visit_call(std::index_sequence<J...>, F& f, Vs&... vs)
+        {
+            constexpr auto& e = visit_layout_v<F, Vs...>.entries[E];
+            return f(visit_arg<bool((e.mask >> J) & 1), e.alts[J]>(vs)...);
+        }
+
+        /// Entry of the flat jump table.
+        template <typename F, std::size_t E, typename... Vs>
+        decltype(auto) visit_call(F& f, Vs&... vs)
+        {
+            return visit_call<F, E>(std::index_sequence_for<Vs...>(), f,
+                                    vs...);
+        }
+
+        template <typename F, typename... Vs, std::size_t... C>
+        decltype(auto) flat_visit(F& f, std::index_sequence<C...>, Vs&... vs)
+        {
+            constexpr auto& layout = visit_layout_v<F, Vs...>;
+
+            using result_type = decltype(visit_call<F, 0>(f, vs...));
+            using entry_type = result_type (*)(F&, Vs&...);
+
+            // Indexed by combination rather than through layout.table: the
+            // table is a few bytes larger, but saves a dependent load.
+            static constexpr entry_type calls[] = {
+                &visit_call<F, layout.table[C], Vs...>...};
+
+            if ((vs.valueless_by_exception() || ...))
+                throw std::bad_variant_access();
+            return calls[combination_index(vs...)](f, vs...);
+        }
+    } // namespace detail
+
+    template <typename F, typename... Vs>
+    decltype(auto) visit(F&& f, Vs&&... vs)
+    {
+        constexpr auto& layout =
+            detail::visit_layout_v<std::remove_reference_t<F>,
+                                   std::remove_reference_t<Vs>...>;
+        static_assert(layout.callable,
+                      "visitor cannot be called with every combination");
+        return detail::flat_visit(
+            f, std::make_index_sequence<layout.table.size()>(), vs...);
+    }
+
+} // namespace misc
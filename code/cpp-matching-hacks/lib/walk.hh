@@ -0,0 +1,67 @@
+/**
+ ** \file misc/walk.hh
+ ** \brief Declaration of misc::walker and misc::walk.
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace misc
+{
+    /// A single-pass, non-recursive, depth-first walk over trees of \a Node,
+    /// whose nodes compute results of type \a R bottom-up.
+    ///
+    /// Each node is reached once and drives every hook of a visitor \a v:
+    /// - \c v.pre(node), optional, before its children;
+    /// - \c v.in(node, i), optional, between its children \a i - 1 and \a i;
+    /// - \c v.post(node, children), after its children, \a children
+    ///   pointing to their results, an empty range for leaves: it must not
+    ///   be dereferenced.  It returns the result of the node.
+    ///
+    /// Results flow bottom-up as the states of a tree automaton do, so a
+    /// selector can match a node and emit its code in post(), while pre()
+    /// and in() emit what comes before and between its children.  Pending
+    /// nodes and results are kept on explicit stacks: deep trees neither
+    /// overflow the call stack nor pay for a call frame per level.  The
+    /// stacks belong to the walker, which should be reused from one tree to
+    /// the next so that they are only allocated once, and can be
+    /// preallocated with reserve().
+    ///
+    /// \a Node must provide \c child_count() and \c child_get(i), the
+    /// latter returning a pointer to the \a i th child.
+    template <typename Node, typename R>
+    class walker
+    {
+    public:
+        /** \brief Walk the tree under \a root with the hooks of \a v,
+         ** return the result of \a root. */
+        template <typename V>
+        R operator()(const Node& root, V&& v);
+
+        /** \brief Preallocate the stacks for trees of nodes with at most
+         ** \a max_arity children, up to \a depth levels deep. */
+        void reserve(std::size_t depth, std::size_t max_arity = 2);
+
+    private:
+        /// A node whose children are being walked.
+        struct frame
+        {
+            const Node* node;
+            std::size_t next;
+            std::size_t arity;
+        };
+
+        std::vector<frame> frames_;
+        std::vector<R> results_;
+    };
+
+    /** \brief Walk the tree under \a root with the hooks of \a v, with a
+     ** fresh misc::walker. */
+    template <typename R, typename Node, typename V>
+    R walk(const Node& root, V&& v);
+
+} // namespace misc
+
+#include "walk.hxx"
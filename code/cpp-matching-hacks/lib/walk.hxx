@@ -0,0 +1,76 @@
+/**
+ ** \file misc/walk.hxx
+ ** \brief Implementation of misc::walker and misc::walk.
+ **/
+
+#pragma once
+
+#include <utility>
+
+#include "walk.hh"
+
+namespace misc
+{
+    template <typename Node, typename R>
+    template <typename V>
+    R walker<Node, R>::operator()(const Node& root, V&& v)
+    {
+        // Left over if a hook threw during the previous walk.
+        frames_.clear();
+        results_.clear();
+
+        // Leaves are done as soon as they are entered, only interior nodes
+        // wait on the frame stack for their children.
+        auto enter = [&](const Node& node) {
+            if constexpr (requires { v.pre(node); })
+                v.pre(node);
+            if (std::size_t arity = node.child_count())
+                frames_.push_back({&node, 0, arity});
+            else
+                results_.push_back(
+                    v.post(node, results_.data() + results_.size()));
+        };
+
+        enter(root);
+        while (!frames_.empty())
+        {
+            frame& f = frames_.back();
+            if (f.next < f.arity)
+            {
+                const Node& node = *f.node;
+                std::size_t i = f.next++;
+                if constexpr (requires { v.in(node, i); })
+                    if (i > 0)
+                        v.in(node, i);
+                // May reallocate the frames, and invalidate f.
+                enter(*node.child_get(i));
+                continue;
+            }
+
+            R res =
+                v.post(*f.node, results_.data() + results_.size() - f.arity);
+            results_.erase(results_.end() - f.arity, results_.end());
+            results_.push_back(res);
+            frames_.pop_back();
+        }
+
+        R res = results_.back();
+        results_.pop_back();
+        return res;
+    }
+
+    template <typename Node, typename R>
+    void walker<Node, R>::reserve(std::size_t depth, std::size_t max_arity)
+    {
+        // Each frame waits on the results of its first children at most.
+        frames_.reserve(depth);
+        results_.reserve(depth * (max_arity ? max_arity - 1 : 0) + 1);
+    }
+
+    template <typename R, typename Node, typename V>
+    R walk(const Node& root, V&& v)
+    {
+        return walker<Node, R>()(root, std::forward<V>(v));
+    }
+
+} // namespace misc
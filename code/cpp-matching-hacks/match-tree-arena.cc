@@ -0,0 +1,219 @@
+// Same as match-tree-step6.cc but nodes are allocated in a misc::arena and
+// referenced through raw non-owning handles instead of std::shared_ptr.
+// Everything is freed at once when the arena goes out of scope.
+
+#include <cassert>
+#include <iostream>
+#include <variant>
+
+#include "lib/arena.hh"
+
+// Forward declarations
+template <typename T1, typename T2>
+struct Tree;
+
+struct Int;
+
+template <typename T>
+struct Mem;
+
+template <typename D, typename S>
+struct Move;
+
+// Handles declarations
+template <typename T1, typename T2>
+using hTree = Tree<T1, T2>*;
+
+using hInt = Int*;
+
+template <typename T>
+using hMem = Mem<T>*;
+
+template <typename D, typename S>
+using hMove = Move<D, S>*;
+
+// Variant declaration
+template <typename T1, typename T2>
+using vTree = std::variant<hMem<T1>, hMove<T1, T2>, hInt>;
+
+template <typename T1, typename T2>
+struct Tree
+{
+    virtual void traverse() = 0;
+
+    virtual vTree<T1, T2> variant() = 0;
+};
+
+// Dummy class
+struct None : public Tree<None, None>
+{
+    virtual void traverse() override
+    {
+        assert(0);
+    }
+
+    virtual vTree<None, None> variant() override
+    {
+        assert(0);
+    }
+};
+
+struct Int : public Tree<None, None>
+{
+    Int(int val)
+        : val(val)
+    {}
+
+    virtual void traverse() override
+    {
+        std::cout << val;
+    }
+
+    // No shared_from_this needed: the handle is the pointer itself
+    virtual vTree<None, None> variant() override
+    {
+        return this;
+    }
+
+    int val;
+};
+
+template <typename T>
+struct Mem : public Tree<T, None>
+{
+    using exp_t = T*;
+
+    Mem(exp_t exp)
+        : exp(exp)
+    {}
+
+    virtual void traverse() override
+    {
+        std::cout << "Mem(";
+        exp->traverse();
+        std::cout << ")";
+    }
+
+    virtual vTree<T, None> variant() override
+    {
+        return this;
+    }
+
+    exp_t exp;
+};
+
+template <typename D, typename S>
+struct Move : public Tree<D, S>
+{
+    using dst_t = D*;
+    using src_t = S*;
+
+    Move(dst_t dst, src_t src)
+        : dst(dst)
+        , src(src)
+    {}
+
+    virtual void traverse() override
+    {
+        std::cout << "Move(";
+        dst->traverse();
+        std::cout << ",";
+        src->traverse();
+        std::cout << ")";
+    }
+
+    virtual vTree<D, S> variant() override
+    {
+        return this;
+    }
+
+    dst_t dst;
+    src_t src;
+};
+
+struct Matcher
+{
+    void operator()(const auto& t)
+    {
+        std::cout << "auto! ";
+        t->traverse();
+        std::cout << std::endl;
+    }
+
+    template <typename T>
+    void operator()(const hMem<Mem<T>>& m)
+    {
+        std::cout << "sMem with a sMem child! ";
+        m->traverse();
+        std::cout << std::endl;
+    }
+
+    template <typename T>
+    void operator()(const hMem<T>& m)
+    {
+        std::cout << "sMem! ";
+        m->traverse();
+        std::cout << std::endl;
+    }
+
+    template <typename T>
+    void operator()(const hMove<T, T>& m)
+    {
+        std::cout << "sMove with same type dst and src! ";
+        m->traverse();
+        std::cout << std::endl;
+    }
+
+    template <typename T1, typename T2>
+    void operator()(const hMove<T1, T2>& m)
+    {
+        std::cout << "sMove with different type dst and src! ";
+        m->traverse();
+        std::cout << std::endl;
+    }
+};
+
+static hInt make_int(misc::arena& arena, int val)
+{
+    return arena.make<Int>(val);
+}
+
+template <typename T>
+static hMem<T> make_mem(misc::arena& arena, T* exp)
+{
+    return arena.make<Mem<T>>(exp);
+}
+
+template <typename D, typename S>
+static hMove<D, S> make_move(misc::arena& arena, D* dst, S* src)
+{
+    return arena.make<Move<D, S>>(dst, src);
+}
+
+int main(void)
+{
+    // One arena per function being lowered
+    misc::arena arena;
+
+    hInt i1 = make_int(arena, 42);
+    hInt i2 = make_int(arena, 21);
+
+    auto mem1 = make_mem(arena, i1);
+    auto mem2 = make_mem(arena, mem1);
+    auto move1 = make_move(arena, i2, mem2);
+    auto move2 = make_move(arena, i2, i1);
+
+    auto t1 = mem1->variant();
+    auto t2 = mem2->variant();
+    auto t3 = move1->variant();
+    auto t4 = move2->variant();
+    auto t5 = i1->variant();
+
+    std::visit(Matcher(), t1);
+    std::visit(Matcher(), t2);
+    std::visit(Matcher(), t3);
+    std::visit(Matcher(), t4);
+    std::visit(Matcher(), t5);
+
+    return 0;
+}
@@ -0,0 +1,226 @@
+// Same tree as match-tree-patterns.cc, but instead of taking the first
+// matching pattern, rules have costs and misc::burg selects the cheapest
+// cover of the whole tree by dynamic programming, like MonoBURG does.
+
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "lib/burg.hh"
+
+//------------------------------------------------------------------//
+//                     Tree classes definitions                     //
+//------------------------------------------------------------------//
+
+/// Tree is the abstract class all nodes inherit from.
+struct Tree
+{
+    enum Kind
+    {
+        INT,
+        MEM,
+        MOVE,
+    };
+
+    static constexpr std::size_t kind_count = 3;
+
+    Tree(Kind kind)
+        : kind(kind)
+    {}
+
+    virtual void traverse() const = 0;
+
+    Kind kind_get() const
+    {
+        return kind;
+    }
+
+    /// The number of children of the node.
+    std::size_t child_count() const
+    {
+        return kind == INT ? 0 : kind == MEM ? 1 : 2;
+    }
+
+    /// The \a i th child of the node, dispatched on the kind tag.
+    const Tree* child_get(std::size_t i) const;
+
+    const Kind kind;
+};
+
+using sTree = std::shared_ptr<Tree>;
+
+/// Int is a leaf, it represents an immediate value.
+struct Int : public Tree
+{
+    Int(int val)
+        : Tree(INT)
+        , val(val)
+    {}
+
+    virtual void traverse() const
+    {
+        std::cout << val;
+    }
+
+    int val;
+};
+
+/// Mem is a node with one child, it represents a memory access.
+struct Mem : public Tree
+{
+    Mem(sTree exp)
+        : Tree(MEM)
+        , exp(exp)
+    {}
+
+    virtual void traverse() const override
+    {
+        std::cout << "Mem(";
+        exp->traverse();
+        std::cout << ")";
+    }
+
+    sTree exp;
+};
+
+/// Move is a node with two children, it represents an assembly move.
+struct Move : public Tree
+{
+    Move(sTree dst, sTree src)
+        : Tree(MOVE)
+        , dst(dst)
+        , src(src)
+    {}
+
+    virtual void traverse() const
+    {
+        std::cout << "Move(";
+        dst->traverse();
+        std::cout << ",";
+        src->traverse();
+        std::cout << ")";
+    }
+
+    sTree dst;
+    sTree src;
+};
+
+const Tree* Tree::child_get(std::size_t i) const
+{
+    switch (kind)
+    {
+    case MEM:
+        return static_cast<const Mem*>(this)->exp.get();
+    case MOVE:
+        return i == 0 ? static_cast<const Move*>(this)->dst.get()
+                      : static_cast<const Move*>(this)->src.get();
+    default:
+        return nullptr;
+    }
+}
+
+//------------------------------------------------------------------//
+//                  Smart pointer types defintions                  //
+//------------------------------------------------------------------//
+
+using sInt = std::shared_ptr<Int>;
+using sMem = std::shared_ptr<Mem>;
+using sMove = std::shared_ptr<Move>;
+
+//------------------------------------------------------------------//
+//                        Rules definitions                         //
+//------------------------------------------------------------------//
+
+/// Nonterminals of the grammar.
+enum Nonterm
+{
+    STMT,
+    REG,
+    IMM,
+    NONTERM_COUNT,
+};
+
+using Rule = misc::burg_rule<Tree>;
+
+static misc::burg_pattern nt(Nonterm nonterm)
+{
+    return misc::burg_pattern::nonterm(nonterm);
+}
+
+static misc::burg_pattern pInt()
+{
+    return {Tree::INT};
+}
+
+static misc::burg_pattern pMem(misc::burg_pattern exp)
+{
+    return {Tree::MEM, {exp}};
+}
+
+static misc::burg_pattern pMove(misc::burg_pattern dst,
+                                misc::burg_pattern src)
+{
+    return {Tree::MOVE, {dst, src}};
+}
+
+/// Action printing \a insn and the node it was emitted for.
+static auto emit(const char* insn)
+{
+    return [insn](const Tree& t) {
+        std::cout << "    " << insn << "\t# ";
+        t.traverse();
+        std::cout << std::endl;
+    };
+}
+
+/// Like the Matcher overloads, but with costs: the cheapest cover wins.
+static std::vector<Rule> rules()
+{
+    return {
+        {IMM, pInt(), 0, "imm: Int", {}},
+        {REG, nt(IMM), 1, "reg: imm", emit("movl $imm, %reg")},
+        {REG, pMem(nt(REG)), 1, "reg: Mem(reg)", emit("movl (%reg), %reg")},
+        {REG, pMem(nt(IMM)), 1, "reg: Mem(imm)", emit("movl imm, %reg")},
+        {STMT, pMove(nt(REG), nt(REG)), 1, "stmt: Move(reg, reg)",
+         emit("movl %reg, %reg")},
+        {STMT, pMove(nt(REG), pMem(nt(REG))), 1, "stmt: Move(reg, Mem(reg))",
+         emit("movl (%reg), %reg")},
+        {STMT, pMove(pMem(nt(REG)), nt(REG)), 1, "stmt: Move(Mem(reg), reg)",
+         emit("movl %reg, (%reg)")},
+        {STMT, pMove(pMem(nt(REG)), nt(IMM)), 1, "stmt: Move(Mem(reg), imm)",
+         emit("movl $imm, (%reg)")},
+        {STMT, nt(REG), 0, "stmt: reg", {}},
+    };
+}
+
+//------------------------------------------------------------------//
+//                          Main function                           //
+//------------------------------------------------------------------//
+
+int main(void)
+{
+    misc::burg<Tree> selector(NONTERM_COUNT, rules());
+
+    sInt i1(new Int(42));
+    sInt i2(new Int(21));
+
+    sMem mem1(new Mem(i1));
+    sMem mem2(new Mem(mem1));
+
+    sMove move1(new Move(i2, mem2));
+    sMove move2(new Move(mem1, i2));
+    sMove move3(new Move(i2, i1));
+
+    for (sTree t : std::initializer_list<sTree>{mem2, move1, move2, move3})
+    {
+        selector.label(*t);
+
+        t->traverse();
+        std::cout << ": cost " << selector.cost(STMT) << std::endl;
+        selector.reduce(STMT);
+    }
+
+    return 0;
+}
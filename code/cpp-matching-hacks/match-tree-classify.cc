@@ -0,0 +1,107 @@
+// Same as match-tree-flat.cc but without the automaton: the nodes of the
+// misc::flat_tree are classified by blocks by a misc::kind_classifier, which
+// compares the kinds of a node and of its children to the shapes of all the
+// rules at once, with AVX2 or SSE2 when the CPU has them.  Only the rules of
+// the candidates of a node need full matching: these ones are no deeper than
+// their shapes, so the first candidate wins.
+
+#include <bit>
+#include <iostream>
+#include <vector>
+
+#include "lib/flat-tree.hh"
+#include "lib/kind-classifier.hh"
+//------------------------------------------------------------------//
+//                         Tree definition                          //
+//------------------------------------------------------------------//
+
+enum Kind
+{
+    INT,
+    MEM,
+    MOVE,
+};
+
+constexpr std::size_t kind_count = 3;
+
+using index_type = misc::flat_tree::index_type;
+
+/// The equivalent of Tree::traverse, on an index.
+void traverse(const misc::flat_tree& tree, index_type t)
+{
+    switch (tree.kind_get(t))
+    {
+    case INT:
+        std::cout << tree.imm_get(t);
+        break;
+    case MEM:
+        std::cout << "Mem(";
+        traverse(tree, tree.child_get(t, 0));
+        std::cout << ")";
+        break;
+    case MOVE:
+        std::cout << "Move(";
+        traverse(tree, tree.child_get(t, 0));
+        std::cout << ",";
+        traverse(tree, tree.child_get(t, 1));
+        std::cout << ")";
+        break;
+    }
+}
+
+//------------------------------------------------------------------//
+//                        Shapes definition                         //
+//------------------------------------------------------------------//
+
+// The rules of match-tree-flat.cc
+static const std::vector<misc::shape> shapes = {
+    {MEM, MEM},       // Mem(Mem(_))
+    {MEM},            // Mem(_)
+    {MOVE, INT, INT}, // Move(Int, Int)
+    {MOVE, MEM, MEM}, // Move(Mem(_), Mem(_))
+    {MOVE},           // Move(_, _)
+    {},               // _
+};
+
+static const char* actions[] = {
+    "Mem with a Mem child! ",
+    "Mem! ",
+    "Move with Int dst and src! ",
+    "Move with Mem dst and src! ",
+    "Move! ",
+    "wild! ",
+};
+
+//------------------------------------------------------------------//
+//                          Main function                           //
+//------------------------------------------------------------------//
+
+int main(void)
+{
+    misc::flat_tree tree;
+
+    auto i1 = tree.add_leaf(INT, 42);
+    auto i2 = tree.add_leaf(INT, 21);
+
+    auto mem1 = tree.add_node(MEM, {i1});
+    auto mem2 = tree.add_node(MEM, {mem1});
+
+    tree.add_node(MOVE, {i2, mem2});
+    tree.add_node(MOVE, {i2, i1});
+    tree.add_node(MOVE, {mem1, mem2});
+
+    misc::kind_classifier classifier(shapes);
+    std::vector<misc::kind_classifier::mask_type> masks;
+    classifier.classify(tree, masks);
+
+    for (index_type t = 0; t < tree.size(); ++t)
+    {
+        std::cout << actions[std::countr_zero(masks[t])];
+        traverse(tree, t);
+        std::cout << std::endl;
+    }
+
+    std::cout << tree.size() << " nodes, classified with "
+              << misc::simd_name(classifier.level_get()) << std::endl;
+    return 0;
+}
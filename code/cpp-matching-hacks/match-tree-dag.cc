@@ -0,0 +1,197 @@
+// Same as match-tree-automaton.cc but the trees are matched as a DAG: step6's
+// trees share subtrees, such as i1 and mem1, and a misc::match_memo side
+// table keyed by node identity makes each of them matched once per pass.
+
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+
+#include "lib/match-memo.hh"
+#include "lib/tree-automaton.hh"
+
+//------------------------------------------------------------------//
+//                     Tree classes definitions                     //
+//------------------------------------------------------------------//
+
+/// Tree is the abstract class all nodes inherit from.
+struct Tree
+{
+    enum Kind
+    {
+        INT,
+        MEM,
+        MOVE,
+    };
+
+    static constexpr std::size_t kind_count = 3;
+
+    Tree(Kind kind)
+        : kind(kind)
+    {}
+
+    virtual void traverse() const = 0;
+
+    Kind kind_get() const
+    {
+        return kind;
+    }
+
+    /// The number of children of the node.
+    std::size_t child_count() const
+    {
+        return kind == INT ? 0 : kind == MEM ? 1 : 2;
+    }
+
+    /// The \a i th child of the node, dispatched on the kind tag.
+    const Tree* child_get(std::size_t i) const;
+
+    const Kind kind;
+};
+
+using sTree = std::shared_ptr<Tree>;
+
+/// Int is a leaf, it represents an immediate value.
+struct Int : public Tree
+{
+    Int(int val)
+        : Tree(INT)
+        , val(val)
+    {}
+
+    virtual void traverse() const
+    {
+        std::cout << val;
+    }
+
+    int val;
+};
+
+/// Mem is a node with one child, it represents a memory access.
+struct Mem : public Tree
+{
+    Mem(sTree exp)
+        : Tree(MEM)
+        , exp(exp)
+    {}
+
+    virtual void traverse() const override
+    {
+        std::cout << "Mem(";
+        exp->traverse();
+        std::cout << ")";
+    }
+
+    sTree exp;
+};
+
+/// Move is a node with two children, it represents an assembly move.
+struct Move : public Tree
+{
+    Move(sTree dst, sTree src)
+        : Tree(MOVE)
+        , dst(dst)
+        , src(src)
+    {}
+
+    virtual void traverse() const
+    {
+        std::cout << "Move(";
+        dst->traverse();
+        std::cout << ",";
+        src->traverse();
+        std::cout << ")";
+    }
+
+    sTree dst;
+    sTree src;
+};
+
+const Tree* Tree::child_get(std::size_t i) const
+{
+    switch (kind)
+    {
+    case MEM:
+        return static_cast<const Mem*>(this)->exp.get();
+    case MOVE:
+        return i == 0 ? static_cast<const Move*>(this)->dst.get()
+                      : static_cast<const Move*>(this)->src.get();
+    default:
+        return nullptr;
+    }
+}
+
+//------------------------------------------------------------------//
+//                  Smart pointer types defintions                  //
+//------------------------------------------------------------------//
+
+using sInt = std::shared_ptr<Int>;
+using sMem = std::shared_ptr<Mem>;
+using sMove = std::shared_ptr<Move>;
+
+//------------------------------------------------------------------//
+//                        Automaton definition                      //
+//------------------------------------------------------------------//
+
+using misc::op;
+using misc::wild;
+
+// The rules of match-tree-step6.cc's Matcher, without its non-linear
+// Move<T, T> rule which patterns cannot express: same kind children instead.
+using Automaton = misc::tree_automaton<
+    Tree::kind_count,
+    op<Tree::MEM, op<Tree::MEM, wild>>,
+    op<Tree::MEM, wild>,
+    op<Tree::MOVE, op<Tree::INT>, op<Tree::INT>>,
+    op<Tree::MOVE, op<Tree::MEM, wild>, op<Tree::MEM, wild>>,
+    op<Tree::MOVE, wild, wild>,
+    wild>;
+
+static const char* actions[] = {
+    "Mem with a Mem child! ",
+    "Mem! ",
+    "Move with Int dst and src! ",
+    "Move with Mem dst and src! ",
+    "Move! ",
+    "wild! ",
+};
+
+//------------------------------------------------------------------//
+//                          Main function                           //
+//------------------------------------------------------------------//
+
+int main(void)
+{
+    sInt i1(new Int(42));
+    sInt i2(new Int(21));
+
+    sMem mem1(new Mem(i1));
+    sMem mem2(new Mem(mem1));
+
+    sMove move1(new Move(i2, mem2));
+    sMove move2(new Move(i2, i1));
+    sMove move3(new Move(mem1, mem2));
+
+    auto roots = std::initializer_list<sTree>{move1, move2, move3};
+
+    int tree_matches = 0;
+    for (sTree t : roots)
+        Automaton::match_all(*t, [&](const Tree&, int) { ++tree_matches; });
+
+    // The pass: the side table is cleared at the end of the scope.
+    misc::match_memo<Automaton::state_type> memo;
+    {
+        misc::match_memo<Automaton::state_type>::pass pass(memo);
+        for (sTree t : roots)
+            Automaton::match_all(*t, pass, [](const Tree& n, int rule) {
+                std::cout << actions[rule];
+                n.traverse();
+                std::cout << std::endl;
+            });
+
+        std::cout << memo.size() << " nodes matched once, instead of "
+                  << tree_matches << " times as trees" << std::endl;
+    }
+
+    return 0;
+}
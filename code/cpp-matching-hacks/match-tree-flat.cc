@@ -0,0 +1,103 @@
+// Same trees and rules as match-tree-automaton.cc, but stored in a
+// misc::flat_tree: no node is allocated, nodes are indices into contiguous
+// arrays of kinds, child indices and immediates.  Since children are stored
+// before their parents, the whole forest is matched by a forward scan.
+
+#include <iostream>
+#include <vector>
+
+#include "lib/flat-tree.hh"
+#include "lib/tree-automaton.hh"
+
+//------------------------------------------------------------------//
+//                         Tree definition                          //
+//------------------------------------------------------------------//
+
+enum Kind
+{
+    INT,
+    MEM,
+    MOVE,
+};
+
+constexpr std::size_t kind_count = 3;
+
+using index_type = misc::flat_tree::index_type;
+
+/// The equivalent of Tree::traverse, on an index.
+void traverse(const misc::flat_tree& tree, index_type t)
+{
+    switch (tree.kind_get(t))
+    {
+    case INT:
+        std::cout << tree.imm_get(t);
+        break;
+    case MEM:
+        std::cout << "Mem(";
+        traverse(tree, tree.child_get(t, 0));
+        std::cout << ")";
+        break;
+    case MOVE:
+        std::cout << "Move(";
+        traverse(tree, tree.child_get(t, 0));
+        std::cout << ",";
+        traverse(tree, tree.child_get(t, 1));
+        std::cout << ")";
+        break;
+    }
+}
+
+//------------------------------------------------------------------//
+//                        Automaton definition                      //
+//------------------------------------------------------------------//
+
+using misc::op;
+using misc::wild;
+
+using Automaton = misc::tree_automaton<
+    kind_count,
+    op<MEM, op<MEM, wild>>,
+    op<MEM, wild>,
+    op<MOVE, op<INT>, op<INT>>,
+    op<MOVE, op<MEM, wild>, op<MEM, wild>>,
+    op<MOVE, wild, wild>,
+    wild>;
+
+static const char* actions[] = {
+    "Mem with a Mem child! ",
+    "Mem! ",
+    "Move with Int dst and src! ",
+    "Move with Mem dst and src! ",
+    "Move! ",
+    "wild! ",
+};
+
+//------------------------------------------------------------------//
+//                          Main function                           //
+//------------------------------------------------------------------//
+
+int main(void)
+{
+    misc::flat_tree tree;
+
+    auto i1 = tree.add_leaf(INT, 42);
+    auto i2 = tree.add_leaf(INT, 21);
+
+    auto mem1 = tree.add_node(MEM, {i1});
+    auto mem2 = tree.add_node(MEM, {mem1});
+
+    tree.add_node(MOVE, {i2, mem2});
+    tree.add_node(MOVE, {i2, i1});
+    tree.add_node(MOVE, {mem1, mem2});
+
+    std::vector<Automaton::state_type> states;
+    Automaton::match_flat(tree, states, [&](index_type t, int rule) {
+        std::cout << actions[rule];
+        traverse(tree, t);
+        std::cout << std::endl;
+    });
+
+    std::cout << tree.size() << " nodes, " << tree.memory() << " bytes"
+              << std::endl;
+    return 0;
+}
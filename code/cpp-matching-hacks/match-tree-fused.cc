@@ -0,0 +1,212 @@
+// Same as match-tree-automaton.cc but printing and matching are fused: instead
+// of a recursive virtual traverse() followed by a matching pass, a single
+// misc::walk reaches each node once, prints it from its pre, in and post
+// hooks, and computes its automaton state and emits its rule in post, as an
+// instruction selector would.  The walk uses explicit stacks, no recursion.
+
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "lib/tree-automaton.hh"
+#include "lib/walk.hh"
+
+//------------------------------------------------------------------//
+//                     Tree classes definitions                     //
+//------------------------------------------------------------------//
+
+/// Tree is the abstract class all nodes inherit from.
+struct Tree
+{
+    enum Kind
+    {
+        INT,
+        MEM,
+        MOVE,
+    };
+
+    static constexpr std::size_t kind_count = 3;
+
+    Tree(Kind kind)
+        : kind(kind)
+    {}
+
+    virtual ~Tree() = default;
+
+    Kind kind_get() const
+    {
+        return kind;
+    }
+
+    /// The number of children of the node.
+    std::size_t child_count() const
+    {
+        return kind == INT ? 0 : kind == MEM ? 1 : 2;
+    }
+
+    /// The \a i th child of the node, dispatched on the kind tag.
+    const Tree* child_get(std::size_t i) const;
+
+    const Kind kind;
+};
+
+using sTree = std::shared_ptr<Tree>;
+
+/// Int is a leaf, it represents an immediate value.
+struct Int : public Tree
+{
+    Int(int val)
+        : Tree(INT)
+        , val(val)
+    {}
+
+    int val;
+};
+
+/// Mem is a node with one child, it represents a memory access.
+struct Mem : public Tree
+{
+    Mem(sTree exp)
+        : Tree(MEM)
+        , exp(exp)
+    {}
+
+    sTree exp;
+};
+
+/// Move is a node with two children, it represents an assembly move.
+struct Move : public Tree
+{
+    Move(sTree dst, sTree src)
+        : Tree(MOVE)
+        , dst(dst)
+        , src(src)
+    {}
+
+    sTree dst;
+    sTree src;
+};
+
+const Tree* Tree::child_get(std::size_t i) const
+{
+    switch (kind)
+    {
+    case MEM:
+        return static_cast<const Mem*>(this)->exp.get();
+    case MOVE:
+        return i == 0 ? static_cast<const Move*>(this)->dst.get()
+                      : static_cast<const Move*>(this)->src.get();
+    default:
+        return nullptr;
+    }
+}
+
+//------------------------------------------------------------------//
+//                  Smart pointer types defintions                  //
+//------------------------------------------------------------------//
+
+using sInt = std::shared_ptr<Int>;
+using sMem = std::shared_ptr<Mem>;
+using sMove = std::shared_ptr<Move>;
+
+//------------------------------------------------------------------//
+//                        Automaton definition                      //
+//------------------------------------------------------------------//
+
+using misc::op;
+using misc::wild;
+
+// The rules of match-tree-step6.cc's Matcher, without its non-linear
+// Move<T, T> rule which patterns cannot express: same kind children instead.
+using Automaton = misc::tree_automaton<
+    Tree::kind_count,
+    op<Tree::MEM, op<Tree::MEM, wild>>,
+    op<Tree::MEM, wild>,
+    op<Tree::MOVE, op<Tree::INT>, op<Tree::INT>>,
+    op<Tree::MOVE, op<Tree::MEM, wild>, op<Tree::MEM, wild>>,
+    op<Tree::MOVE, wild, wild>,
+    wild>;
+
+static const char* actions[] = {
+    "Mem with a Mem child! ",
+    "Mem! ",
+    "Move with Int dst and src! ",
+    "Move with Mem dst and src! ",
+    "Move! ",
+    "wild! ",
+};
+
+//------------------------------------------------------------------//
+//                       Fused walk definition                      //
+//------------------------------------------------------------------//
+
+using state_type = Automaton::state_type;
+
+/// Print and match every node in one walk, emitting the rule of each node
+/// bottom-up.
+struct Selector
+{
+    void pre(const Tree& t)
+    {
+        if (t.kind_get() == Tree::MEM)
+            text << "Mem(";
+        else if (t.kind_get() == Tree::MOVE)
+            text << "Move(";
+    }
+
+    void in(const Tree&, std::size_t)
+    {
+        text << ",";
+    }
+
+    state_type post(const Tree& t, const state_type* children)
+    {
+        if (t.kind_get() == Tree::INT)
+            text << static_cast<const Int&>(t).val;
+        else
+            text << ")";
+
+        std::size_t arity = t.child_count();
+        state_type res = Automaton::state(t.kind_get(),
+                                          arity > 0 ? children[0] : 0,
+                                          arity > 1 ? children[1] : 0);
+        code << " " << Automaton::rule(res);
+        return res;
+    }
+
+    std::ostringstream text;
+    std::ostringstream code;
+};
+
+//------------------------------------------------------------------//
+//                          Main function                           //
+//------------------------------------------------------------------//
+
+int main(void)
+{
+    sInt i1(new Int(42));
+    sInt i2(new Int(21));
+
+    sMem mem1(new Mem(i1));
+    sMem mem2(new Mem(mem1));
+
+    sMove move1(new Move(i2, mem2));
+    sMove move2(new Move(i2, i1));
+    sMove move3(new Move(mem1, mem2));
+
+    for (sTree t :
+         std::initializer_list<sTree>{mem1, mem2, move1, move2, move3, i1})
+    {
+        Selector selector;
+        state_type s = misc::walk<state_type>(*t, selector);
+        std::cout << actions[Automaton::rule(s)] << selector.text.str()
+                  << std::endl
+                  << "  rules emitted:" << selector.code.str() << std::endl;
+    }
+
+    std::cout << Automaton::state_count() << " states" << std::endl;
+    return 0;
+}
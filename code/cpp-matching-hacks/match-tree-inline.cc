@@ -0,0 +1,189 @@
+// Same as match-tree-arena.cc but the hierarchy is closed and leaves are not
+// nodes: an Int is stored inline in its parent's child slot, a
+// misc::tagged_child, and only Mem and Move nodes are allocated in the arena.
+// Children are matched through a closed variant of Int values and interior
+// node handles, computed from the slot tag and the node kind, without any
+// virtual call.
+
+#include <iostream>
+#include <type_traits>
+#include <variant>
+
+#include "lib/arena.hh"
+#include "lib/tagged-child.hh"
+
+// Forward declarations
+struct Tree;
+struct Mem;
+struct Move;
+
+// A child slot: an inline Int or a handle on an interior node
+using child = misc::tagged_child<Tree>;
+
+// Leaves are values, not nodes
+struct Int
+{
+    int val;
+};
+
+// Variant declaration, closed over every kind of child
+using vTree = std::variant<Mem*, Move*, Int>;
+
+/// Tree is the base of the interior nodes, which are only Mem and Move.
+struct Tree
+{
+    enum Kind
+    {
+        MEM,
+        MOVE,
+    };
+
+    Tree(Kind kind)
+        : kind(kind)
+    {}
+
+    Kind kind_get() const
+    {
+        return kind;
+    }
+
+    const Kind kind;
+};
+
+struct Mem final : public Tree
+{
+    Mem(child exp)
+        : Tree(MEM)
+        , exp(exp)
+    {}
+
+    child exp;
+};
+
+struct Move final : public Tree
+{
+    Move(child dst, child src)
+        : Tree(MOVE)
+        , dst(dst)
+        , src(src)
+    {}
+
+    child dst;
+    child src;
+};
+
+// No virtual needed: the hierarchy is closed, the kind is enough
+static vTree variant(child c)
+{
+    return c.visit([](auto x) -> vTree {
+        if constexpr (std::is_same_v<decltype(x), child::imm_type>)
+            return Int{x};
+        else if (x->kind_get() == Tree::MEM)
+            return static_cast<Mem*>(x);
+        else
+            return static_cast<Move*>(x);
+    });
+}
+
+static void traverse(child c);
+
+struct Traverser
+{
+    void operator()(Int i)
+    {
+        std::cout << i.val;
+    }
+
+    void operator()(Mem* m)
+    {
+        std::cout << "Mem(";
+        traverse(m->exp);
+        std::cout << ")";
+    }
+
+    void operator()(Move* m)
+    {
+        std::cout << "Move(";
+        traverse(m->dst);
+        std::cout << ",";
+        traverse(m->src);
+        std::cout << ")";
+    }
+};
+
+static void traverse(child c)
+{
+    std::visit(Traverser(), variant(c));
+}
+
+struct Matcher
+{
+    void operator()(Int i)
+    {
+        std::cout << "auto! ";
+        traverse(i.val);
+        std::cout << std::endl;
+    }
+
+    void operator()(Mem* m)
+    {
+        if (std::holds_alternative<Mem*>(variant(m->exp)))
+            std::cout << "sMem with a sMem child! ";
+        else
+            std::cout << "sMem! ";
+        traverse(m);
+        std::cout << std::endl;
+    }
+
+    // Children are no longer typed: only their kinds can be compared
+    void operator()(Move* m)
+    {
+        if (variant(m->dst).index() == variant(m->src).index())
+            std::cout << "sMove with same kind dst and src! ";
+        else
+            std::cout << "sMove with different kind dst and src! ";
+        traverse(m);
+        std::cout << std::endl;
+    }
+};
+
+static Mem* make_mem(misc::arena& arena, child exp)
+{
+    return arena.make<Mem>(exp);
+}
+
+static Move* make_move(misc::arena& arena, child dst, child src)
+{
+    return arena.make<Move>(dst, src);
+}
+
+int main(void)
+{
+    // Only the interior nodes are allocated
+    misc::arena arena;
+
+    child i1 = 42;
+    child i2 = 21;
+
+    auto mem1 = make_mem(arena, i1);
+    auto mem2 = make_mem(arena, mem1);
+    auto move1 = make_move(arena, i2, mem2);
+    auto move2 = make_move(arena, i2, i1);
+
+    auto t1 = variant(mem1);
+    auto t2 = variant(mem2);
+    auto t3 = variant(move1);
+    auto t4 = variant(move2);
+    auto t5 = variant(i1);
+
+    std::visit(Matcher(), t1);
+    std::visit(Matcher(), t2);
+    std::visit(Matcher(), t3);
+    std::visit(Matcher(), t4);
+    std::visit(Matcher(), t5);
+
+    std::cout << "4 nodes in " << arena.used() << " bytes, children of "
+              << sizeof(child) << " bytes" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,256 @@
+// Same as match-tree-automaton.cc but trees are printed and matched by an
+// iterative driver: a misc::walker with an explicit, preallocated stack,
+// reused from one tree to the next.  Its output is the same as the recursive
+// traverse()'s, but chains such as Mem(Mem(Mem(...))) can be as deep as
+// memory allows instead of overflowing the call stack.
+
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "lib/tree-automaton.hh"
+#include "lib/walk.hh"
+
+//------------------------------------------------------------------//
+//                     Tree classes definitions                     //
+//------------------------------------------------------------------//
+
+/// Tree is the abstract class all nodes inherit from.
+struct Tree
+{
+    enum Kind
+    {
+        INT,
+        MEM,
+        MOVE,
+    };
+
+    static constexpr std::size_t kind_count = 3;
+
+    Tree(Kind kind)
+        : kind(kind)
+    {}
+
+    virtual void traverse() const = 0;
+
+    Kind kind_get() const
+    {
+        return kind;
+    }
+
+    /// The number of children of the node.
+    std::size_t child_count() const
+    {
+        return kind == INT ? 0 : kind == MEM ? 1 : 2;
+    }
+
+    /// The \a i th child of the node, dispatched on the kind tag.
+    const Tree* child_get(std::size_t i) const;
+
+    const Kind kind;
+};
+
+using sTree = std::shared_ptr<Tree>;
+
+/// Int is a leaf, it represents an immediate value.
+struct Int : public Tree
+{
+    Int(int val)
+        : Tree(INT)
+        , val(val)
+    {}
+
+    virtual void traverse() const
+    {
+        std::cout << val;
+    }
+
+    int val;
+};
+
+/// Mem is a node with one child, it represents a memory access.
+struct Mem : public Tree
+{
+    Mem(sTree exp)
+        : Tree(MEM)
+        , exp(exp)
+    {}
+
+    virtual void traverse() const override
+    {
+        std::cout << "Mem(";
+        exp->traverse();
+        std::cout << ")";
+    }
+
+    sTree exp;
+};
+
+/// Move is a node with two children, it represents an assembly move.
+struct Move : public Tree
+{
+    Move(sTree dst, sTree src)
+        : Tree(MOVE)
+        , dst(dst)
+        , src(src)
+    {}
+
+    virtual void traverse() const
+    {
+        std::cout << "Move(";
+        dst->traverse();
+        std::cout << ",";
+        src->traverse();
+        std::cout << ")";
+    }
+
+    sTree dst;
+    sTree src;
+};
+
+const Tree* Tree::child_get(std::size_t i) const
+{
+    switch (kind)
+    {
+    case MEM:
+        return static_cast<const Mem*>(this)->exp.get();
+    case MOVE:
+        return i == 0 ? static_cast<const Move*>(this)->dst.get()
+                      : static_cast<const Move*>(this)->src.get();
+    default:
+        return nullptr;
+    }
+}
+
+//------------------------------------------------------------------//
+//                  Smart pointer types defintions                  //
+//------------------------------------------------------------------//
+
+using sInt = std::shared_ptr<Int>;
+using sMem = std::shared_ptr<Mem>;
+using sMove = std::shared_ptr<Move>;
+
+//------------------------------------------------------------------//
+//                        Automaton definition                      //
+//------------------------------------------------------------------//
+
+using misc::op;
+using misc::wild;
+
+// The rules of match-tree-step6.cc's Matcher, without its non-linear
+// Move<T, T> rule which patterns cannot express: same kind children instead.
+using Automaton = misc::tree_automaton<
+    Tree::kind_count,
+    op<Tree::MEM, op<Tree::MEM, wild>>,
+    op<Tree::MEM, wild>,
+    op<Tree::MOVE, op<Tree::INT>, op<Tree::INT>>,
+    op<Tree::MOVE, op<Tree::MEM, wild>, op<Tree::MEM, wild>>,
+    op<Tree::MOVE, wild, wild>,
+    wild>;
+
+static const char* actions[] = {
+    "Mem with a Mem child! ",
+    "Mem! ",
+    "Move with Int dst and src! ",
+    "Move with Mem dst and src! ",
+    "Move! ",
+    "wild! ",
+};
+
+//------------------------------------------------------------------//
+//                         Iterative driver                         //
+//------------------------------------------------------------------//
+
+using state_type = Automaton::state_type;
+
+/// Print like traverse() and match like Automaton::match_all, in one walk.
+struct Driver
+{
+    void pre(const Tree& t)
+    {
+        if (t.kind_get() == Tree::MEM)
+            out << "Mem(";
+        else if (t.kind_get() == Tree::MOVE)
+            out << "Move(";
+    }
+
+    void in(const Tree&, std::size_t)
+    {
+        out << ",";
+    }
+
+    state_type post(const Tree& t, const state_type* children)
+    {
+        if (t.kind_get() == Tree::INT)
+            out << static_cast<const Int&>(t).val;
+        else
+            out << ")";
+
+        std::size_t arity = t.child_count();
+        return Automaton::state(t.kind_get(), arity > 0 ? children[0] : 0,
+                                arity > 1 ? children[1] : 0);
+    }
+
+    std::ostream& out;
+};
+
+/// What the recursive traverse() prints.
+static std::string traversed(const Tree& t)
+{
+    std::ostringstream out;
+    auto buf = std::cout.rdbuf(out.rdbuf());
+    t.traverse();
+    std::cout.rdbuf(buf);
+    return out.str();
+}
+
+//------------------------------------------------------------------//
+//                          Main function                           //
+//------------------------------------------------------------------//
+
+int main(void)
+{
+    // A chain of Mem deep enough for the recursion to be noticeable, but not
+    // to overflow: destroying it is recursive too
+    constexpr std::size_t chain_length = 10000;
+
+    // One walker for every tree, its stacks are only allocated once: deep
+    // enough for the deepest tree, the chain and its Int
+    misc::walker<Tree, state_type> walker;
+    walker.reserve(chain_length + 1);
+
+    sInt i1(new Int(42));
+    sInt i2(new Int(21));
+
+    sMem mem1(new Mem(i1));
+    sMem mem2(new Mem(mem1));
+
+    sMove move1(new Move(i2, mem2));
+    sMove move2(new Move(i2, i1));
+    sMove move3(new Move(mem1, mem2));
+
+    for (sTree t :
+         std::initializer_list<sTree>{mem1, mem2, move1, move2, move3, i1})
+    {
+        std::ostringstream out;
+        state_type s = walker(*t, Driver{out});
+        std::cout << actions[Automaton::rule(s)] << out.str() << std::endl;
+        assert(out.str() == traversed(*t));
+    }
+
+    sTree chain(new Int(0));
+    for (std::size_t i = 0; i < chain_length; ++i)
+        chain = sMem(new Mem(chain));
+    std::ostringstream out;
+    state_type s = walker(*chain, Driver{out});
+    std::cout << actions[Automaton::rule(s)] << out.str().size()
+              << " characters, same as traverse(): "
+              << (out.str() == traversed(*chain)) << std::endl;
+
+    std::cout << Automaton::state_count() << " states" << std::endl;
+    return 0;
+}
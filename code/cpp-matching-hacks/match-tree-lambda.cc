@@ -0,0 +1,128 @@
+// Same as match-tree.cc but the matcher is a misc::LambdaVisitor visited with
+// misc::visit.  Its catch-all takes an sTree rather than auto: sMove and sInt
+// reach nothing else, and share a single function, where the auto! overload
+// of match-tree.cc is instantiated for both of them.
+
+#include <iostream>
+#include <memory>
+#include <variant>
+
+#include "lib/lambda-visitor.hh"
+#include "lib/visit.hh"
+
+//------------------------------------------------------------------//
+//                     Tree classes definitions                     //
+//------------------------------------------------------------------//
+
+/// Tree is the abstract class all nodes inherit from.
+struct Tree
+{
+    virtual void traverse() = 0;
+};
+
+using sTree = std::shared_ptr<Tree>;
+
+/// Int is a leaf, it represents an immediate value.
+struct Int : public Tree
+{
+    Int(int val)
+        : val(val)
+    {}
+
+    virtual void traverse()
+    {
+        std::cout << val;
+    }
+
+    int val;
+};
+
+/// Mem is a node with one child, it represents a memory access.
+struct Mem : public Tree
+{
+    Mem(sTree exp)
+        : exp(exp)
+    {}
+
+    virtual void traverse() override
+    {
+        std::cout << "Mem(";
+        exp->traverse();
+        std::cout << ")";
+    }
+
+    sTree exp;
+};
+
+/// Move is a node with two children, it represents an assembly move.
+struct Move : public Tree
+{
+    Move(sTree dst, sTree src)
+        : dst(dst)
+        , src(src)
+    {}
+
+    virtual void traverse()
+    {
+        std::cout << "Move(";
+        dst->traverse();
+        std::cout << ",";
+        src->traverse();
+        std::cout << ")";
+    }
+
+    sTree dst;
+    sTree src;
+};
+
+//------------------------------------------------------------------//
+//                  Smart pointer types defintions                  //
+//------------------------------------------------------------------//
+
+using sInt = std::shared_ptr<Int>;
+using sMem = std::shared_ptr<Mem>;
+using sMove = std::shared_ptr<Move>;
+
+//------------------------------------------------------------------//
+//                        Variant definition                        //
+//------------------------------------------------------------------//
+
+using vTree = std::variant<sMem, sMove, sInt>;
+
+//------------------------------------------------------------------//
+//                        Matcher definition                        //
+//------------------------------------------------------------------//
+
+static auto matcher = misc::LambdaVisitor{
+    [](const sTree& t) {
+        std::cout << "auto! ";
+        t->traverse();
+        std::cout << std::endl;
+    },
+    [](const sMem& m) {
+        std::cout << "sMem! ";
+        m->traverse();
+        std::cout << std::endl;
+    },
+};
+
+//------------------------------------------------------------------//
+//                          Main function                           //
+//------------------------------------------------------------------//
+
+int main(void)
+{
+    sInt i1(new Int(42));
+    sInt i2(new Int(21));
+
+    sMem mem(new Mem(i1));
+
+    sMove move(new Move(i2, mem));
+
+    vTree t1 = move;
+    vTree t2 = mem;
+
+    misc::visit(matcher, t1); // auto!
+    misc::visit(matcher, t2); // sMem!
+    return 0;
+}
@@ -0,0 +1,234 @@
+// Same as match-tree-step6.cc but the children of a Move are matched through
+// misc::lazy_variant views: the variant() of a child is only built when an
+// arm dispatches on it, as in the slides' GasMatcher, where one side of a
+// Binop is often enough.
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <type_traits>
+#include <variant>
+
+#include "lib/lazy-variant.hh"
+
+// Forward declarations
+template <typename T1, typename T2>
+struct Tree;
+
+struct Int;
+
+template <typename T>
+struct Mem;
+
+template <typename D, typename S>
+struct Move;
+
+// Smart pointers declarations
+template <typename T1, typename T2>
+using sTree = std::shared_ptr<Tree<T1, T2>>;
+
+using sInt = std::shared_ptr<Int>;
+
+template <typename T>
+using sMem = std::shared_ptr<Mem<T>>;
+
+template <typename D, typename S>
+using sMove = std::shared_ptr<Move<D, S>>;
+
+// Variant declaration
+template <typename T1, typename T2>
+using vTree = std::variant<sMem<T1>, sMove<T1, T2>, sInt>;
+
+template <typename T1, typename T2>
+struct Tree
+{
+    virtual void traverse() = 0;
+
+    virtual vTree<T1, T2> variant() = 0;
+};
+
+// Dummy class
+struct None : public Tree<None, None>
+{
+    virtual void traverse() override
+    {
+        assert(0);
+    }
+
+    virtual vTree<None, None> variant() override
+    {
+        assert(0);
+    }
+};
+
+struct Int
+    : public Tree<None, None>
+    , std::enable_shared_from_this<Int>
+{
+    Int(int val)
+        : val(val)
+    {}
+
+    virtual void traverse() override
+    {
+        std::cout << val;
+    }
+
+    virtual vTree<None, None> variant() override
+    {
+        sInt res(this->shared_from_this());
+        return res;
+    }
+
+    int val;
+};
+
+template <typename T>
+struct Mem
+    : public Tree<T, None>
+    , std::enable_shared_from_this<Mem<T>>
+{
+    using exp_t = std::shared_ptr<T>;
+
+    Mem(exp_t exp)
+        : exp(exp)
+    {}
+
+    virtual void traverse() override
+    {
+        std::cout << "Mem(";
+        exp->traverse();
+        std::cout << ")";
+    }
+
+    virtual vTree<T, None> variant() override
+    {
+        sMem<T> res(this->shared_from_this());
+        return res;
+    }
+
+    exp_t exp;
+};
+
+template <typename D, typename S>
+struct Move
+    : public Tree<D, S>
+    , std::enable_shared_from_this<Move<D, S>>
+{
+    using dst_t = std::shared_ptr<D>;
+    using src_t = std::shared_ptr<S>;
+
+    Move(dst_t dst, src_t src)
+        : dst(dst)
+        , src(src)
+    {}
+
+    virtual void traverse() override
+    {
+        std::cout << "Move(";
+        dst->traverse();
+        std::cout << ",";
+        src->traverse();
+        std::cout << ")";
+    }
+
+    virtual vTree<D, S> variant() override
+    {
+        sMove<D, S> res(this->shared_from_this());
+        return res;
+    }
+
+    dst_t dst;
+    src_t src;
+};
+
+struct Matcher
+{
+    void operator()(const auto& t)
+    {
+        std::cout << "auto! ";
+        t->traverse();
+        std::cout << std::endl;
+    }
+
+    template <typename T>
+    void operator()(const sMem<Mem<T>>& m)
+    {
+        std::cout << "sMem with a sMem child! ";
+        m->traverse();
+        std::cout << std::endl;
+    }
+
+    template <typename T>
+    void operator()(const sMem<T>& m)
+    {
+        std::cout << "sMem! ";
+        m->traverse();
+        std::cout << std::endl;
+    }
+
+    template <typename D, typename S>
+    void operator()(const sMove<D, S>& m)
+    {
+        auto dst = misc::lazy(m->dst);
+        auto src = misc::lazy(m->src);
+
+        // Dispatch on the source only: the variant of the destination is
+        // built by the arm that needs it, not up front.
+        src.visit([&](const auto& s) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(s)>, sInt>)
+                std::cout << "sMove of an immediate! ";
+            else
+                dst.visit([](const auto& d) {
+                    if constexpr (requires { d->exp; })
+                        std::cout << "sMove to memory! ";
+                    else
+                        std::cout << "sMove! ";
+                });
+        });
+        m->traverse();
+        std::cout << (dst.materialized() ? "" : " (dst not materialized)")
+                  << std::endl;
+    }
+};
+
+template <typename T>
+static sMem<T> make_mem(const std::shared_ptr<T>& exp)
+{
+    return sMem<T>(new Mem(exp));
+}
+
+template <typename D, typename S>
+static sMove<D, S> make_move(const std::shared_ptr<D>& dst,
+                             const std::shared_ptr<S>& src)
+{
+    return sMove<D, S>(new Move(dst, src));
+}
+
+int main(void)
+{
+    sInt i1(new Int(42));
+    sInt i2(new Int(21));
+
+    auto mem1 = make_mem(i1);
+    auto mem2 = make_mem(mem1);
+    auto move1 = make_move(i2, mem2);
+    auto move2 = make_move(i2, i1);
+    auto move3 = make_move(mem1, mem2);
+
+    auto t1 = mem1->variant();
+    auto t2 = mem2->variant();
+    auto t3 = move1->variant();
+    auto t4 = move2->variant();
+    auto t5 = i1->variant();
+    auto t6 = move3->variant();
+
+    std::visit(Matcher(), t1);
+    std::visit(Matcher(), t2);
+    std::visit(Matcher(), t3);
+    std::visit(Matcher(), t4);
+    std::visit(Matcher(), t5);
+    std::visit(Matcher(), t6);
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+// Same as match-tree.cc but a batch of trees is matched in parallel by
+// misc::parallel_match.  Trees share their leaves, whose std::shared_ptr
+// reference counts are updated by every thread, and the outputs come out in
+// the order of the trees whatever the number of threads.
+
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "lib/parallel-match.hh"
+
+//------------------------------------------------------------------//
+//                     Tree classes definitions                     //
+//------------------------------------------------------------------//
+
+/// Tree is the abstract class all nodes inherit from.
+struct Tree
+{
+    virtual void traverse(std::ostream& o) = 0;
+};
+
+using sTree = std::shared_ptr<Tree>;
+
+/// Int is a leaf, it represents an immediate value.
+struct Int : public Tree
+{
+    Int(int val)
+        : val(val)
+    {}
+
+    virtual void traverse(std::ostream& o)
+    {
+        o << val;
+    }
+
+    int val;
+};
+
+/// Mem is a node with one child, it represents a memory access.
+struct Mem : public Tree
+{
+    Mem(sTree exp)
+        : exp(exp)
+    {}
+
+    virtual void traverse(std::ostream& o) override
+    {
+        o << "Mem(";
+        exp->traverse(o);
+        o << ")";
+    }
+
+    sTree exp;
+};
+
+/// Move is a node with two children, it represents an assembly move.
+struct Move : public Tree
+{
+    Move(sTree dst, sTree src)
+        : dst(dst)
+        , src(src)
+    {}
+
+    virtual void traverse(std::ostream& o)
+    {
+        o << "Move(";
+        dst->traverse(o);
+        o << ",";
+        src->traverse(o);
+        o << ")";
+    }
+
+    sTree dst;
+    sTree src;
+};
+
+//------------------------------------------------------------------//
+//                  Smart pointer types defintions                  //
+//------------------------------------------------------------------//
+
+using sInt = std::shared_ptr<Int>;
+using sMem = std::shared_ptr<Mem>;
+using sMove = std::shared_ptr<Move>;
+
+//------------------------------------------------------------------//
+//                       Variant declaration                        //
+//------------------------------------------------------------------//
+
+using vTree = std::variant<sMem, sMove, sInt>;
+
+//------------------------------------------------------------------//
+//                       Matcher declaration                        //
+//------------------------------------------------------------------//
+
+/// Matchers take references by value: every match copies them.
+struct Matcher
+{
+    std::string operator()(sTree t)
+    {
+        std::ostringstream o;
+        o << "auto! ";
+        t->traverse(o);
+        return o.str();
+    }
+
+    std::string operator()(sMem m)
+    {
+        std::ostringstream o;
+        o << "sMem! ";
+        m->traverse(o);
+        return o.str();
+    }
+};
+
+//------------------------------------------------------------------//
+//                          Main function                           //
+//------------------------------------------------------------------//
+
+int main(void)
+{
+    sInt i1(new Int(42));
+    sInt i2(new Int(21));
+
+    std::vector<vTree> trees;
+    for (int i = 0; i < 1000; ++i)
+    {
+        sMem mem(new Mem(i % 2 ? i1 : sInt(new Int(i))));
+        if (i % 3)
+            trees.push_back(sMove(new Move(i2, mem)));
+        else
+            trees.push_back(mem);
+    }
+
+    auto match = [](const vTree& t, std::vector<std::string>& out) {
+        out.push_back(std::visit(Matcher(), t));
+    };
+
+    using misc::parallel_match;
+    auto sequential = parallel_match<std::string, vTree>(trees, match, 1);
+    auto parallel = parallel_match<std::string, vTree>(trees, match, 4, 16);
+
+    for (int i = 0; i < 4; ++i)
+        std::cout << parallel[i] << std::endl;
+    std::cout << "..." << std::endl;
+    std::cout << parallel.size() << " matches, "
+              << (parallel == sequential ? "in order" : "out of order")
+              << ", i1 has " << i1.use_count() << " references" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,188 @@
+// Based on match-tree.cc: destructuring without templating the nodes.
+// Nodes carry a kind tag, and a set of patterns such as Move(Mem(_), Int) is
+// compiled at run-time into a decision tree (misc::pattern_matcher) testing
+// each node's tag at most once.
+
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+
+#include "lib/pattern-matcher.hh"
+
+//------------------------------------------------------------------//
+//                     Tree classes definitions                     //
+//------------------------------------------------------------------//
+
+/// Tree is the abstract class all nodes inherit from.
+struct Tree
+{
+    enum Kind
+    {
+        INT,
+        MEM,
+        MOVE,
+    };
+
+    static constexpr std::size_t kind_count = 3;
+
+    Tree(Kind kind)
+        : kind(kind)
+    {}
+
+    virtual void traverse() = 0;
+
+    Kind kind_get() const
+    {
+        return kind;
+    }
+
+    /// The \a i th child of the node, dispatched on the kind tag.
+    const Tree* child_get(std::size_t i) const;
+
+    const Kind kind;
+};
+
+using sTree = std::shared_ptr<Tree>;
+
+/// Int is a leaf, it represents an immediate value.
+struct Int : public Tree
+{
+    Int(int val)
+        : Tree(INT)
+        , val(val)
+    {}
+
+    virtual void traverse()
+    {
+        std::cout << val;
+    }
+
+    int val;
+};
+
+/// Mem is a node with one child, it represents a memory access.
+struct Mem : public Tree
+{
+    Mem(sTree exp)
+        : Tree(MEM)
+        , exp(exp)
+    {}
+
+    virtual void traverse() override
+    {
+        std::cout << "Mem(";
+        exp->traverse();
+        std::cout << ")";
+    }
+
+    sTree exp;
+};
+
+/// Move is a node with two children, it represents an assembly move.
+struct Move : public Tree
+{
+    Move(sTree dst, sTree src)
+        : Tree(MOVE)
+        , dst(dst)
+        , src(src)
+    {}
+
+    virtual void traverse()
+    {
+        std::cout << "Move(";
+        dst->traverse();
+        std::cout << ",";
+        src->traverse();
+        std::cout << ")";
+    }
+
+    sTree dst;
+    sTree src;
+};
+
+const Tree* Tree::child_get(std::size_t i) const
+{
+    switch (kind)
+    {
+    case MEM:
+        return static_cast<const Mem*>(this)->exp.get();
+    case MOVE:
+        return i == 0 ? static_cast<const Move*>(this)->dst.get()
+                      : static_cast<const Move*>(this)->src.get();
+    default:
+        return nullptr;
+    }
+}
+
+//------------------------------------------------------------------//
+//                  Smart pointer types defintions                  //
+//------------------------------------------------------------------//
+
+using sInt = std::shared_ptr<Int>;
+using sMem = std::shared_ptr<Mem>;
+using sMove = std::shared_ptr<Move>;
+
+//------------------------------------------------------------------//
+//                       Patterns definitions                       //
+//------------------------------------------------------------------//
+
+static misc::pattern pInt()
+{
+    return {Tree::INT};
+}
+
+static misc::pattern pMem(misc::pattern exp)
+{
+    return {Tree::MEM, {exp}};
+}
+
+static misc::pattern pMove(misc::pattern dst, misc::pattern src)
+{
+    return {Tree::MOVE, {dst, src}};
+}
+
+//------------------------------------------------------------------//
+//                          Main function                           //
+//------------------------------------------------------------------//
+
+int main(void)
+{
+    using misc::_;
+
+    // Like an OCaml match, the first matching pattern wins
+    misc::pattern_matcher<Tree> matcher({
+        pMove(pMem(_), pInt()), // 0
+        pMove(_, pMem(_)),      // 1
+        pMove(_, _),            // 2
+        pMem(pMem(_)),          // 3
+        pMem(_),                // 4
+        _,                      // 5
+    });
+
+    const char* actions[] = {
+        "Move(Mem(_), Int)! ", "Move(_, Mem(_))! ", "Move(_, _)! ",
+        "Mem(Mem(_))! ",       "Mem(_)! ",          "_! ",
+    };
+
+    sInt i1(new Int(42));
+    sInt i2(new Int(21));
+
+    sMem mem1(new Mem(i1));
+    sMem mem2(new Mem(mem1));
+
+    sMove move1(new Move(i2, mem2));
+    sMove move2(new Move(mem1, i2));
+    sMove move3(new Move(i2, i1));
+
+    for (sTree t :
+         std::initializer_list<sTree>{mem1, mem2, move1, move2, move3, i1})
+    {
+        std::cout << actions[matcher.match(*t)];
+        t->traverse();
+        std::cout << std::endl;
+    }
+
+    std::cout << matcher.size() << " states" << std::endl;
+    return 0;
+}
@@ -0,0 +1,212 @@
+// Same as match-tree-patterns.cc but the patterns are tried one after the
+// other (misc::rule_chain), as a hand-written matcher tests them.  A first
+// run counts the hits of each pattern into a misc::rule_profile, and a second
+// one loads it to try the hottest patterns first, as far as the first match
+// allows: Mem(Mem(_)) stays before Mem(_), which it overlaps.
+
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "lib/rule-chain.hh"
+
+//------------------------------------------------------------------//
+//                     Tree classes definitions                     //
+//------------------------------------------------------------------//
+
+/// Tree is the abstract class all nodes inherit from.
+struct Tree
+{
+    enum Kind
+    {
+        INT,
+        MEM,
+        MOVE,
+    };
+
+    static constexpr std::size_t kind_count = 3;
+
+    Tree(Kind kind)
+        : kind(kind)
+    {}
+
+    virtual void traverse() = 0;
+
+    Kind kind_get() const
+    {
+        return kind;
+    }
+
+    /// The \a i th child of the node, dispatched on the kind tag.
+    const Tree* child_get(std::size_t i) const;
+
+    const Kind kind;
+};
+
+using sTree = std::shared_ptr<Tree>;
+
+/// Int is a leaf, it represents an immediate value.
+struct Int : public Tree
+{
+    Int(int val)
+        : Tree(INT)
+        , val(val)
+    {}
+
+    virtual void traverse()
+    {
+        std::cout << val;
+    }
+
+    int val;
+};
+
+/// Mem is a node with one child, it represents a memory access.
+struct Mem : public Tree
+{
+    Mem(sTree exp)
+        : Tree(MEM)
+        , exp(exp)
+    {}
+
+    virtual void traverse() override
+    {
+        std::cout << "Mem(";
+        exp->traverse();
+        std::cout << ")";
+    }
+
+    sTree exp;
+};
+
+/// Move is a node with two children, it represents an assembly move.
+struct Move : public Tree
+{
+    Move(sTree dst, sTree src)
+        : Tree(MOVE)
+        , dst(dst)
+        , src(src)
+    {}
+
+    virtual void traverse()
+    {
+        std::cout << "Move(";
+        dst->traverse();
+        std::cout << ",";
+        src->traverse();
+        std::cout << ")";
+    }
+
+    sTree dst;
+    sTree src;
+};
+
+const Tree* Tree::child_get(std::size_t i) const
+{
+    switch (kind)
+    {
+    case MEM:
+        return static_cast<const Mem*>(this)->exp.get();
+    case MOVE:
+        return i == 0 ? static_cast<const Move*>(this)->dst.get()
+                      : static_cast<const Move*>(this)->src.get();
+    default:
+        return nullptr;
+    }
+}
+
+//------------------------------------------------------------------//
+//                  Smart pointer types defintions                  //
+//------------------------------------------------------------------//
+
+using sInt = std::shared_ptr<Int>;
+using sMem = std::shared_ptr<Mem>;
+using sMove = std::shared_ptr<Move>;
+
+//------------------------------------------------------------------//
+//                       Patterns definitions                       //
+//------------------------------------------------------------------//
+
+static misc::pattern pInt()
+{
+    return {Tree::INT};
+}
+
+static misc::pattern pMem(misc::pattern exp)
+{
+    return {Tree::MEM, {exp}};
+}
+
+static misc::pattern pMove(misc::pattern dst, misc::pattern src)
+{
+    return {Tree::MOVE, {dst, src}};
+}
+
+//------------------------------------------------------------------//
+
+//------------------------------------------------------------------//
+//                          Main function                           //
+//------------------------------------------------------------------//
+
+int main(void)
+{
+    using misc::_;
+
+    // Like an OCaml match, the first matching pattern wins
+    const std::vector<misc::pattern> patterns = {
+        pMove(pMem(_), pInt()), // 0
+        pMove(_, pMem(_)),      // 1
+        pMove(_, _),            // 2
+        pMem(pMem(_)),          // 3
+        pMem(_),                // 4
+        _,                      // 5
+    };
+
+    const char* actions[] = {
+        "Move(Mem(_), Int)! ", "Move(_, Mem(_))! ", "Move(_, _)! ",
+        "Mem(Mem(_))! ",       "Mem(_)! ",          "_! ",
+    };
+
+    sInt i1(new Int(42));
+    sInt i2(new Int(21));
+
+    sMem mem1(new Mem(i1));
+    sMem mem2(new Mem(mem1));
+
+    sMove move1(new Move(i2, mem2));
+    sMove move2(new Move(mem1, i2));
+    sMove move3(new Move(i2, i1));
+
+    // Mostly Int and Mem(_)
+    std::initializer_list<sTree> workload = {
+        mem1, i1, mem1, i2, move3, mem2, mem1, i1, move1, i2, move2,
+    };
+
+    // Profiling run: the patterns are tried in their order
+    misc::rule_chain<Tree> chain(patterns);
+    misc::rule_profile profile(patterns.size());
+    for (sTree t : workload)
+        profile.hit(chain.match(*t));
+
+    // Stands for the profile file
+    std::stringstream file;
+    profile.save(file);
+    std::cout << file.str();
+
+    // Later run: the hottest patterns first
+    misc::rule_chain<Tree> hot(patterns, misc::rule_profile::load(file));
+    hot.write_order(std::cout, "match_order");
+
+    for (sTree t :
+         std::initializer_list<sTree>{mem1, mem2, move1, move2, move3, i1})
+    {
+        std::cout << actions[hot.match(*t)];
+        t->traverse();
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,206 @@
+// Same trees and rules as match-tree-flat.cc, but the trees come from a
+// frontend as a binary stream in prefix order, written by a misc::tree_writer.
+// A misc::tree_reader builds nodes as soon as their children are read,
+// straight into their final representation: first a misc::flat_tree holding
+// the whole forest, then arena nodes matched statement by statement as they
+// arrive, the arena being reset after each of them.
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "lib/arena.hh"
+#include "lib/flat-tree.hh"
+#include "lib/tree-automaton.hh"
+#include "lib/tree-stream.hh"
+
+//------------------------------------------------------------------//
+//                         Tree definitions                         //
+//------------------------------------------------------------------//
+
+enum Kind
+{
+    INT,
+    MEM,
+    MOVE,
+};
+
+constexpr std::size_t kind_count = 3;
+
+using index_type = misc::flat_tree::index_type;
+
+/// The equivalent of Tree::traverse, on an index.
+void traverse(const misc::flat_tree& tree, index_type t)
+{
+    switch (tree.kind_get(t))
+    {
+    case INT:
+        std::cout << tree.imm_get(t);
+        break;
+    case MEM:
+        std::cout << "Mem(";
+        traverse(tree, tree.child_get(t, 0));
+        std::cout << ")";
+        break;
+    case MOVE:
+        std::cout << "Move(";
+        traverse(tree, tree.child_get(t, 0));
+        std::cout << ",";
+        traverse(tree, tree.child_get(t, 1));
+        std::cout << ")";
+        break;
+    }
+}
+
+/// A node allocated in an arena, of any kind.
+struct Node
+{
+    Node(Kind kind, int val, const Node* left = nullptr,
+         const Node* right = nullptr)
+        : kind(kind)
+        , val(val)
+        , children{left, right}
+    {}
+
+    std::size_t kind_get() const
+    {
+        return kind;
+    }
+
+    std::size_t child_count() const
+    {
+        return kind == INT ? 0 : kind == MEM ? 1 : 2;
+    }
+
+    const Node* child_get(std::size_t i) const
+    {
+        return children[i];
+    }
+
+    void traverse() const
+    {
+        if (kind == INT)
+            std::cout << val;
+        else
+        {
+            std::cout << (kind == MEM ? "Mem(" : "Move(");
+            children[0]->traverse();
+            if (kind == MOVE)
+            {
+                std::cout << ",";
+                children[1]->traverse();
+            }
+            std::cout << ")";
+        }
+    }
+
+    Kind kind;
+    int val;
+    const Node* children[2];
+};
+
+/// Build the nodes read by a misc::tree_reader in an arena.
+struct ArenaBuilder
+{
+    const Node* leaf(misc::tree_writer::kind_type kind, int val)
+    {
+        return arena.make<Node>(Kind(kind), val);
+    }
+
+    const Node* node(misc::tree_writer::kind_type kind,
+                     const Node* const* children, std::size_t arity)
+    {
+        return arena.make<Node>(Kind(kind), 0, children[0],
+                                arity > 1 ? children[1] : nullptr);
+    }
+
+    misc::arena& arena;
+};
+
+//------------------------------------------------------------------//
+//                        Automaton definition                      //
+//------------------------------------------------------------------//
+
+using misc::op;
+using misc::wild;
+
+using Automaton = misc::tree_automaton<
+    kind_count,
+    op<MEM, op<MEM, wild>>,
+    op<MEM, wild>,
+    op<MOVE, op<INT>, op<INT>>,
+    op<MOVE, op<MEM, wild>, op<MEM, wild>>,
+    op<MOVE, wild, wild>,
+    wild>;
+
+static const char* actions[] = {
+    "Mem with a Mem child! ",
+    "Mem! ",
+    "Move with Int dst and src! ",
+    "Move with Mem dst and src! ",
+    "Move! ",
+    "wild! ",
+};
+
+//------------------------------------------------------------------//
+//                          Main function                           //
+//------------------------------------------------------------------//
+
+int main(void)
+{
+    // What the frontend sends: each statement in prefix order
+    std::stringstream stream;
+    misc::tree_writer writer(stream);
+
+    writer.node(MEM, 1); // Mem(42)
+    writer.leaf(INT, 42);
+    writer.node(MEM, 1); // Mem(Mem(42))
+    writer.node(MEM, 1);
+    writer.leaf(INT, 42);
+    writer.node(MOVE, 2); // Move(21,Mem(Mem(42)))
+    writer.leaf(INT, 21);
+    writer.node(MEM, 1);
+    writer.node(MEM, 1);
+    writer.leaf(INT, 42);
+    writer.node(MOVE, 2); // Move(21,42)
+    writer.leaf(INT, 21);
+    writer.leaf(INT, 42);
+    writer.node(MOVE, 2); // Move(Mem(42),Mem(Mem(42)))
+    writer.node(MEM, 1);
+    writer.leaf(INT, 42);
+    writer.node(MEM, 1);
+    writer.node(MEM, 1);
+    writer.leaf(INT, 42);
+    writer.leaf(INT, -42); // -42
+
+    std::cout << stream.str().size() << " bytes" << std::endl;
+
+    // The whole forest in a flat tree, matched by a forward scan
+    misc::flat_tree tree;
+    misc::flat_builder builder(tree);
+    misc::tree_reader<index_type> flat_reader(stream);
+    auto statements = flat_reader.for_each(builder, [](index_type) {});
+
+    std::vector<Automaton::state_type> states;
+    Automaton::match_flat(tree, states, [&](index_type t, int rule) {
+        std::cout << actions[rule];
+        traverse(tree, t);
+        std::cout << std::endl;
+    });
+    std::cout << statements << " statements, " << tree.size() << " nodes"
+              << std::endl;
+
+    // One statement at a time, never resident together
+    stream.clear();
+    stream.seekg(0);
+    misc::arena arena;
+    misc::tree_reader<const Node*> reader(stream);
+    reader.for_each(ArenaBuilder{arena}, [&](const Node* root) {
+        std::cout << actions[Automaton::match(*root)];
+        root->traverse();
+        std::cout << std::endl;
+        arena.reset();
+    });
+
+    return 0;
+}
@@ -0,0 +1,245 @@
+// Same as match-tree-step6.cc but matching goes through a node kind tag stored
+// in the Tree base and a constexpr jump table (misc::tag_visit) instead of the
+// variant() virtual method: no temporary variant, no reference counting.
+
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <variant>
+
+#include "lib/tag-visit.hh"
+
+// Forward declarations
+template <typename T1, typename T2>
+struct Tree;
+
+struct Int;
+
+template <typename T>
+struct Mem;
+
+template <typename D, typename S>
+struct Move;
+
+// Smart pointers declarations
+template <typename T1, typename T2>
+using sTree = std::shared_ptr<Tree<T1, T2>>;
+
+using sInt = std::shared_ptr<Int>;
+
+template <typename T>
+using sMem = std::shared_ptr<Mem<T>>;
+
+template <typename D, typename S>
+using sMove = std::shared_ptr<Move<D, S>>;
+
+// Variant declaration
+template <typename T1, typename T2>
+using vTree = std::variant<sMem<T1>, sMove<T1, T2>, sInt>;
+
+// Kind tags, in the same order as the variant alternatives
+enum class Kind : std::uint8_t
+{
+    MEM,
+    MOVE,
+    INT,
+};
+
+template <typename T1, typename T2>
+struct Tree
+{
+    using alternatives_type = misc::alternatives<Mem<T1>, Move<T1, T2>, Int>;
+
+    Tree(Kind kind)
+        : kind(kind)
+    {}
+
+    Kind kind_get() const
+    {
+        return kind;
+    }
+
+    virtual void traverse() = 0;
+
+    virtual vTree<T1, T2> variant() = 0;
+
+    const Kind kind;
+};
+
+// Dummy class
+struct None : public Tree<None, None>
+{
+    virtual void traverse() override
+    {
+        assert(0);
+    }
+
+    virtual vTree<None, None> variant() override
+    {
+        assert(0);
+    }
+};
+
+struct Int
+    : public Tree<None, None>
+    , std::enable_shared_from_this<Int>
+{
+    Int(int val)
+        : Tree(Kind::INT)
+        , val(val)
+    {}
+
+    virtual void traverse() override
+    {
+        std::cout << val;
+    }
+
+    virtual vTree<None, None> variant() override
+    {
+        sInt res(this->shared_from_this());
+        return res;
+    }
+
+    int val;
+};
+
+template <typename T>
+struct Mem
+    : public Tree<T, None>
+    , std::enable_shared_from_this<Mem<T>>
+{
+    using exp_t = std::shared_ptr<T>;
+
+    Mem(exp_t exp)
+        : Tree<T, None>(Kind::MEM)
+        , exp(exp)
+    {}
+
+    virtual void traverse() override
+    {
+        std::cout << "Mem(";
+        exp->traverse();
+        std::cout << ")";
+    }
+
+    virtual vTree<T, None> variant() override
+    {
+        sMem<T> res(this->shared_from_this());
+        return res;
+    }
+
+    exp_t exp;
+};
+
+template <typename D, typename S>
+struct Move
+    : public Tree<D, S>
+    , std::enable_shared_from_this<Move<D, S>>
+{
+    using dst_t = std::shared_ptr<D>;
+    using src_t = std::shared_ptr<S>;
+
+    Move(dst_t dst, src_t src)
+        : Tree<D, S>(Kind::MOVE)
+        , dst(dst)
+        , src(src)
+    {}
+
+    virtual void traverse() override
+    {
+        std::cout << "Move(";
+        dst->traverse();
+        std::cout << ",";
+        src->traverse();
+        std::cout << ")";
+    }
+
+    virtual vTree<D, S> variant() override
+    {
+        sMove<D, S> res(this->shared_from_this());
+        return res;
+    }
+
+    dst_t dst;
+    src_t src;
+};
+
+// Same overloads as in match-tree-step6.cc, on node references
+struct Matcher
+{
+    void operator()(auto& t)
+    {
+        std::cout << "auto! ";
+        t.traverse();
+        std::cout << std::endl;
+    }
+
+    template <typename T>
+    void operator()(Mem<Mem<T>>& m)
+    {
+        std::cout << "sMem with a sMem child! ";
+        m.traverse();
+        std::cout << std::endl;
+    }
+
+    template <typename T>
+    void operator()(Mem<T>& m)
+    {
+        std::cout << "sMem! ";
+        m.traverse();
+        std::cout << std::endl;
+    }
+
+    template <typename T>
+    void operator()(Move<T, T>& m)
+    {
+        std::cout << "sMove with same type dst and src! ";
+        m.traverse();
+        std::cout << std::endl;
+    }
+
+    template <typename T1, typename T2>
+    void operator()(Move<T1, T2>& m)
+    {
+        std::cout << "sMove with different type dst and src! ";
+        m.traverse();
+        std::cout << std::endl;
+    }
+};
+
+template <typename T>
+static sMem<T> make_mem(const std::shared_ptr<T>& exp)
+{
+    return sMem<T>(new Mem(exp));
+}
+
+template <typename D, typename S>
+static sMove<D, S> make_move(const std::shared_ptr<D>& dst,
+                             const std::shared_ptr<S>& src)
+{
+    return sMove<D, S>(new Move(dst, src));
+}
+
+int main(void)
+{
+    sInt i1(new Int(42));
+    sInt i2(new Int(21));
+
+    auto mem1 = make_mem(i1);
+    auto mem2 = make_mem(mem1);
+    auto move1 = make_move(i2, mem2);
+    auto move2 = make_move(i2, i1);
+
+    misc::tag_visit(Matcher(), *mem1);
+    misc::tag_visit(Matcher(), *mem2);
+    misc::tag_visit(Matcher(), *move1);
+    misc::tag_visit(Matcher(), *move2);
+    misc::tag_visit(Matcher(), *i1);
+
+    // The tag gives access to the dynamic type
+    sTree<Int, None> tree = mem1;
+    misc::tag_visit(Matcher(), *tree);
+
+    return 0;
+}
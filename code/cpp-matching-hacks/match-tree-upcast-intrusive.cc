@@ -0,0 +1,115 @@
+// match-tree-upcast-ref.cc with the fixed misc::ref, using the intrusive
+// reference counting policy: the count is stored in the nodes, references are
+// a single pointer wide and counting is not atomic.
+
+#include <iostream>
+#include <variant>
+
+#include "lib/ref-fixed.hh"
+
+template <typename T>
+using ref = misc::ref<T, misc::intrusive_policy<>>;
+
+struct Tree : public misc::ref_counted<>
+{
+    virtual void traverse() = 0;
+};
+
+struct Int : public Tree
+{
+    Int(int val)
+        : val(val)
+    {}
+
+    virtual void traverse()
+    {
+        std::cout << val;
+    }
+
+    int val;
+};
+
+using sTree = ref<Tree>;
+
+struct Mem : public Tree
+{
+    Mem(sTree exp)
+        : exp(exp)
+    {}
+
+    virtual void traverse() override
+    {
+        std::cout << "Mem(";
+        exp->traverse();
+        std::cout << ")";
+    }
+
+    sTree exp;
+};
+
+struct Move : public Tree
+{
+    Move(sTree dst, sTree src)
+        : dst(dst)
+        , src(src)
+    {}
+
+    virtual void traverse()
+    {
+        std::cout << "Move(";
+        dst->traverse();
+        std::cout << ",";
+        src->traverse();
+        std::cout << ")";
+    }
+
+    sTree dst;
+    sTree src;
+};
+
+using sInt = ref<Int>;
+using sMem = ref<Mem>;
+using sMove = ref<Move>;
+
+using vTree = std::variant<sMem, sMove, sInt>;
+
+struct Matcher
+{
+    void operator()(sTree t)
+    {
+        std::cout << "sTree! ";
+        t->traverse();
+        std::cout << std::endl;
+    }
+
+    void operator()(sMem m)
+    {
+        std::cout << "sMem! ";
+        m->traverse();
+        std::cout << std::endl;
+    }
+};
+
+int main(void)
+{
+    sInt i1(new Int(42));
+    sInt i2(new Int(21));
+    sMem mem(new Mem(i1));
+    sMove move(new Move(i2, mem));
+    vTree t1 = move;
+    vTree t2 = mem;
+
+    std::visit(Matcher(), t1);
+    std::visit(Matcher(), t2);
+
+    sTree t = move->src;
+    std::cout << "src is a Mem: " << t.is_a<Mem>() << ", "
+              << t.cast<Mem>()->exp.use_count() << " references to its child"
+              << std::endl;
+
+    std::cout << "sizeof(sTree): " << sizeof(sTree)
+              << ", sizeof(misc::ref<Tree>): " << sizeof(misc::ref<Tree>)
+              << std::endl;
+
+    return 0;
+}
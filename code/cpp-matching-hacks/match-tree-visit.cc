@@ -0,0 +1,188 @@
+// Same as match-tree.cc but a Move is matched on its two children at once, as
+// the GasMatcher of the slides does on the operands of a binary operation.
+// Instead of nested std::visit, misc::visit jumps through one flat table
+// indexed by both alternatives, and the overloads taking misc::whole, which
+// do not care about an alternative, are one entry shared by all of them.
+
+#include <iostream>
+#include <memory>
+#include <variant>
+
+#include "lib/visit.hh"
+
+//------------------------------------------------------------------//
+//                     Tree classes definitions                     //
+//------------------------------------------------------------------//
+
+struct Int;
+struct Mem;
+struct Move;
+
+using sInt = std::shared_ptr<Int>;
+using sMem = std::shared_ptr<Mem>;
+using sMove = std::shared_ptr<Move>;
+
+using vTree = std::variant<sMem, sMove, sInt>;
+
+/// Tree is the abstract class all nodes inherit from.
+struct Tree
+{
+    virtual void traverse() = 0;
+
+    virtual vTree variant() = 0;
+};
+
+using sTree = std::shared_ptr<Tree>;
+
+/// Int is a leaf, it represents an immediate value.
+struct Int
+    : public Tree
+    , std::enable_shared_from_this<Int>
+{
+    Int(int val)
+        : val(val)
+    {}
+
+    virtual void traverse() override
+    {
+        std::cout << val;
+    }
+
+    virtual vTree variant() override
+    {
+        return shared_from_this();
+    }
+
+    int val;
+};
+
+/// Mem is a node with one child, it represents a memory access.
+struct Mem
+    : public Tree
+    , std::enable_shared_from_this<Mem>
+{
+    Mem(sTree exp)
+        : exp(exp)
+    {}
+
+    virtual void traverse() override
+    {
+        std::cout << "Mem(";
+        exp->traverse();
+        std::cout << ")";
+    }
+
+    virtual vTree variant() override
+    {
+        return shared_from_this();
+    }
+
+    sTree exp;
+};
+
+/// Move is a node with two children, it represents an assembly move.
+struct Move
+    : public Tree
+    , std::enable_shared_from_this<Move>
+{
+    Move(sTree dst, sTree src)
+        : dst(dst)
+        , src(src)
+    {}
+
+    virtual void traverse() override
+    {
+        std::cout << "Move(";
+        dst->traverse();
+        std::cout << ",";
+        src->traverse();
+        std::cout << ")";
+    }
+
+    virtual vTree variant() override
+    {
+        return shared_from_this();
+    }
+
+    sTree dst;
+    sTree src;
+};
+
+//------------------------------------------------------------------//
+//                        Matcher definition                        //
+//------------------------------------------------------------------//
+
+using wTree = misc::whole<vTree>;
+
+static void traverse(wTree t)
+{
+    std::visit([](const auto& n) { n->traverse(); }, t.get());
+}
+
+/// Matcher of the children of a Move.
+struct MoveMatcher
+{
+    void operator()(const sInt& dst, const sInt& src)
+    {
+        std::cout << "Move with Int dst and src! ";
+        dst->traverse();
+        std::cout << ",";
+        src->traverse();
+        std::cout << std::endl;
+    }
+
+    void operator()(const sMem& dst, const sMem& src)
+    {
+        std::cout << "Move with Mem dst and src! ";
+        dst->traverse();
+        std::cout << ",";
+        src->traverse();
+        std::cout << std::endl;
+    }
+
+    // Shared by the three alternatives of dst
+    void operator()(wTree dst, const sInt& src)
+    {
+        std::cout << "Move with Int src! ";
+        traverse(dst);
+        std::cout << ",";
+        src->traverse();
+        std::cout << std::endl;
+    }
+
+    // Shared by every other combination
+    void operator()(wTree dst, wTree src)
+    {
+        std::cout << "Move! ";
+        traverse(dst);
+        std::cout << ",";
+        traverse(src);
+        std::cout << std::endl;
+    }
+};
+
+static void match(const sMove& move)
+{
+    misc::visit(MoveMatcher(), move->dst->variant(), move->src->variant());
+}
+
+//------------------------------------------------------------------//
+//                          Main function                           //
+//------------------------------------------------------------------//
+
+int main(void)
+{
+    sInt i1(new Int(42));
+    sInt i2(new Int(21));
+
+    sMem mem1(new Mem(i1));
+    sMem mem2(new Mem(mem1));
+
+    match(sMove(new Move(i2, i1)));     // Move with Int dst and src!
+    match(sMove(new Move(mem1, mem2))); // Move with Mem dst and src!
+    match(sMove(new Move(mem2, i1)));   // Move with Int src!
+    match(sMove(new Move(i2, mem1)));   // Move!
+
+    // 9 combinations of alternatives, but only 4 functions in the table
+    return 0;
+}
@@ -0,0 +1,30 @@
+// Same as minmax.cc using misc::visit_arms: only the arms are instantiated,
+// not the 256 combinations of alternatives, so 8 variants compile instantly.
+
+#include <iostream>
+#include <variant>
+
+#include "lib/visit-arms.hh"
+
+using variant = std::variant<int, float>;
+using misc::any;
+
+int main()
+{
+    variant i = 0;
+    variant f = 1.5f;
+
+    auto arms = std::tuple{
+        misc::arm<int, int, any, any, any, any, any, any>(
+            [](int, int, const auto&...) { std::cout << "two ints first\n"; }),
+        misc::arm<float, any, any, any, any, any, any, any>(
+            [](float, const auto&...) { std::cout << "float first\n"; }),
+        // The catch-all arm gets the variants and is instantiated once
+        misc::arm<any, any, any, any, any, any, any, any>(
+            [](const auto&...) { std::cout << "whatever\n"; }),
+    };
+
+    misc::visit_arms(arms, i, i, i, i, i, i, i, i);
+    misc::visit_arms(arms, f, i, f, i, f, i, f, i);
+    misc::visit_arms(arms, i, f, i, f, i, f, i, f);
+}